@@ -5,28 +5,64 @@
  * 
  * Implements an artificial ecosystem with predators and prey on a toroidal grid.
  * Run with ./compile-run.sh and view web interface at http://localhost:8000/ (Chrome or Safari recommended).
+ * Larger worlds can be opened with, for example, http://localhost:8000/?width=1000&height=1000&updates=2.
  */
 
 
+#include <emscripten.h>
+#include <emscripten/html5.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "emp/base/vector.hpp"
 #include "emp/math/Random.hpp"
 #include "emp/web/Animate.hpp"
 #include "emp/web/web.hpp"
 #include "World.h"
+#include "Checkpoint.h"
+#include "FrameRing.h"
 #include "Org.h"
 #include "Predator.h"
 #include "Prey.h"
 
 emp::web::Document doc{"target"};
 
+/**
+ * Reads a positive whole number from the page's query string (e.g. ?width=500).
+ * @param name The parameter's name.
+ * @param fallback The value to use if the parameter is missing or not a positive number.
+ * @return The parameter's value.
+ */
+int GetPageParam(const char* name, int fallback) {
+    return EM_ASM_INT({
+        var value = parseInt(new URLSearchParams(window.location.search).get(UTF8ToString($0)));
+        return value > 0 ? value : $1;
+    }, name, fallback);
+}
+
+
 /**
  * Manages the animation of an artificial ecosystem with predators and prey.
+ *
+ * The world is updated on its own thread (a Web Worker, through Emscripten's pthreads), so large grids never stall
+ * the page. Each animation frame grants the simulation thread updatesPerFrame more updates; the simulation thread
+ * paints the cells each update changed and publishes finished pictures to a FrameRing, and the browser's
+ * rendering loop on the main thread draws whichever picture is newest. The display therefore runs at the browser's
+ * frame rate however long updates take, and the buttons stay responsive.
  */
 class AEAnimate : public emp::web::Animate {
 
-    // arena width and height
-    const int num_h_boxes = 70;
-    const int num_w_boxes = 70;
-    const double RECT_SIDE = 8; // grid cell length in pixels
+    // arena width and height, 70x70 unless given in the page's query string
+    const int num_h_boxes = GetPageParam("height", 70);
+    const int num_w_boxes = GetPageParam("width", 70);
+    const size_t updatesPerFrame = GetPageParam("updates", 1); // updates granted per animation frame
+    const double MAX_CANVAS_SIDE = 560; // pixels
+    const double RECT_SIDE = std::max(1.0, std::floor(MAX_CANVAS_SIDE / std::max(num_w_boxes, num_h_boxes))); // grid cell length in pixels
     const double width{num_w_boxes * RECT_SIDE};
     const double height{num_h_boxes * RECT_SIDE};
 
@@ -35,6 +71,202 @@ class AEAnimate : public emp::web::Animate {
 
     emp::web::Canvas canvas{width, height, "canvas"};
 
+    // one RGBA pixel per grid cell, updated only where the world changed and copied into a frame when published
+    emp::vector<uint8_t> pixels = emp::vector<uint8_t>(num_w_boxes * num_h_boxes * 4);
+    bool paintedAll = false;
+    FrameRing frames; // pictures published by the simulation thread, drawn by the main thread
+
+    // once the simulation thread starts, the world, pixels, and publishing side of frames belong to it alone; the
+    // main thread only grants updates and asks for saves and restores, which the simulation thread runs between
+    // updates, so the page never waits on the world
+    enum class StorageRequest {None, Save, Restore};
+    std::mutex creditMutex; // guards credits, storageRequest, and stopping
+    std::condition_variable creditsGranted;
+    size_t credits = 0;     // updates the simulation thread may still run
+    StorageRequest storageRequest = StorageRequest::None; // the latest save or restore asked for and not yet run
+    bool stopping = false;
+    std::thread simulation;
+
+    // checkpoints are kept in IndexedDB (mounted here) so they survive a page reload
+    const std::string CHECKPOINT_PATH = "/persist/world.ckpt";
+
+
+    /**
+     * Colors a cell's pixel by the type of organism in it.
+     * @param org_num The cell's position in the population.
+     */
+    void PaintCell(size_t org_num) {
+        uint8_t red = 0, green = 0, blue = 0;
+        if (world.IsOccupied(org_num)) {
+            Species species = world.GetOrg(org_num).GetSpecies();
+            if (species == Species::Predator) {red = 255;}
+            else if (species == Species::Prey) {blue = 255;}
+        }
+        else { // uninhabited cells are grass
+            green = 128;
+        }
+        // cells are laid out in columns, matching the original cell-by-cell drawing
+        size_t x = org_num / num_h_boxes;
+        size_t y = org_num % num_h_boxes;
+        uint8_t* pixel = &pixels[(y * num_w_boxes + x) * 4];
+        pixel[0] = red;
+        pixel[1] = green;
+        pixel[2] = blue;
+        pixel[3] = 255;
+    }
+
+
+    /**
+     * Repaints the cells whose occupant changed since the last call (or every cell after a restore) and, if the
+     * renderer has taken the last picture or this is the last update granted, publishes a new one. Skipping
+     * publication while the renderer falls behind keeps fast updates from spending their time copying frames.
+     * Call it on the simulation thread (or before it starts).
+     * @param lastGranted Whether no further updates are granted yet.
+     */
+    void PaintAndPublish(bool lastGranted) {
+        if (paintedAll) {
+            for (size_t org_num : world.GetChangedCells()) {
+                PaintCell(org_num);
+            }
+        }
+        else {
+            for (size_t org_num = 0; org_num < world.GetSize(); org_num++) {
+                PaintCell(org_num);
+            }
+            paintedAll = true;
+        }
+        world.ClearChangedCells();
+
+        if (lastGranted || !frames.HasFresh()) {
+            Frame &frame = frames.ProducerFrame();
+            frame.pixels = pixels;
+            frame.update = world.GetUpdate();
+            frames.Publish();
+        }
+    }
+
+
+    /**
+     * Runs on the simulation thread: waits for updates to be granted or for a save or restore to be asked for, and
+     * runs them, until the animation is destroyed. A pending save or restore runs before the next update.
+     */
+    void SimulationLoop() {
+        while (true) {
+            bool lastGranted = false;
+            StorageRequest request;
+            {
+                std::unique_lock<std::mutex> lock(creditMutex);
+                creditsGranted.wait(lock, [this]() {
+                    return stopping || credits > 0 || storageRequest != StorageRequest::None;
+                });
+                if (stopping) {
+                    return;
+                }
+                request = storageRequest;
+                storageRequest = StorageRequest::None;
+                if (request == StorageRequest::None) {lastGranted = --credits == 0;}
+            }
+            if (request == StorageRequest::Save) {SaveState();}
+            else if (request == StorageRequest::Restore) {RestoreState();}
+            else {
+                world.Update();
+                PaintAndPublish(lastGranted);
+            }
+        }
+    }
+
+
+    /**
+     * Asks the simulation thread to save or restore the world before its next update. Called from the page's
+     * buttons on the main thread, which returns at once; a request replaces one that hasn't run yet.
+     * @param request What to do.
+     */
+    void RequestStorage(StorageRequest request) {
+        {
+            std::lock_guard<std::mutex> lock(creditMutex);
+            storageRequest = request;
+        }
+        creditsGranted.notify_one();
+    }
+
+
+    /**
+     * Called by the browser before each repaint: draws the newest published picture, if there is one.
+     */
+    static EM_BOOL RenderFrame(double, void* userData) {
+        AEAnimate* animation = static_cast<AEAnimate*>(userData);
+        if (const Frame* frame = animation->frames.Take()) {
+            animation->DrawPixels(*frame);
+        }
+        return EM_TRUE;
+    }
+
+
+    /**
+     * Draws a frame onto the canvas, scaling each pixel up to a grid cell, in a single call into JavaScript.
+     * With threads, the heap is a SharedArrayBuffer, which ImageData won't accept, so the pixels are copied out.
+     * @param frame The frame to draw.
+     */
+    void DrawPixels(const Frame &frame) {
+        EM_ASM({
+            var canvas = document.getElementById('canvas');
+            if (!Module.aeCells) {
+                Module.aeCells = document.createElement('canvas');
+                Module.aeCells.width = $1;
+                Module.aeCells.height = $2;
+            }
+            var image = new ImageData(new Uint8ClampedArray(HEAPU8.slice($0, $0 + $1 * $2 * 4).buffer), $1, $2);
+            Module.aeCells.getContext('2d').putImageData(image, 0, 0);
+            var context = canvas.getContext('2d');
+            context.imageSmoothingEnabled = false;
+            context.drawImage(Module.aeCells, 0, 0, $3, $4);
+        }, frame.pixels.data(), num_w_boxes, num_h_boxes, width, height);
+    }
+
+    /**
+     * Saves the world to the browser's persistent storage. Runs on the simulation thread; copying the file into
+     * IndexedDB is asynchronous and is started on the main thread, where the file system's JavaScript lives.
+     */
+    void SaveState() {
+        std::string error;
+        if (!SaveCheckpoint(world, CHECKPOINT_PATH, error)) {
+            std::cerr << error << std::endl;
+            return;
+        }
+        MAIN_THREAD_ASYNC_EM_ASM({
+            FS.syncfs(false, function(err) { if (err) console.error('checkpoint sync failed', err); });
+        });
+    }
+
+
+    /**
+     * Restores the world from the browser's persistent storage and publishes its picture. Runs on the simulation
+     * thread. Checkpoints of another grid size (saved on a page opened with other dimensions) are refused, as the
+     * canvas, pixels, and frames are sized for the page's grid.
+     */
+    void RestoreState() {
+        std::string error;
+        CheckpointFile file;
+        if (!file.Open(CHECKPOINT_PATH, error)) {
+            std::cerr << error << std::endl;
+            return;
+        }
+        if (file.GetHeader().width != (uint64_t) num_w_boxes || file.GetHeader().height != (uint64_t) num_h_boxes) {
+            std::cerr << "the saved world is " << file.GetHeader().width << "x" << file.GetHeader().height
+                      << ", not " << num_w_boxes << "x" << num_h_boxes << "; open the page with that size to restore it"
+                      << std::endl;
+            return;
+        }
+        file.Close();
+
+        if (!LoadCheckpoint(world, CHECKPOINT_PATH, error)) {
+            std::cerr << error << std::endl;
+            return;
+        }
+        paintedAll = false;
+        PaintAndPublish(true);
+    }
+
     public:
 
     /**
@@ -44,51 +276,53 @@ class AEAnimate : public emp::web::Animate {
 
         doc << "<div style \"display: flex\">";
         doc << "<div>" << canvas.SetCSS("margin", "8px").SetCSS("float", "left");
-        doc << GetToggleButton("Toggle").SetCSS("margin-top", "8px") << GetStepButton("Step").SetCSS("margin-top", "8px") << "</div>";
+        doc << GetToggleButton("Toggle").SetCSS("margin-top", "8px") << GetStepButton("Step").SetCSS("margin-top", "8px");
+        doc << emp::web::Button([this](){ RequestStorage(StorageRequest::Save); }, "Save").SetCSS("margin-top", "8px");
+        doc << emp::web::Button([this](){ RequestStorage(StorageRequest::Restore); }, "Restore").SetCSS("margin-top", "8px") << "</div>";
         doc << "<div><p>" << "This program implements an artificial ecosystem with two species that evolve and engage in ecological interactions (predation and competition) on a toroidal grid. Predators are depicted as red, prey are depicted as blue, and uninhabited squares of grass are depicted as green. The dynamic oscillates between predators dominating and prey dominating." << "</p>";
         doc << "<p>" << "Predators are stronger and reproduce more slowly, while prey are weaker but reproduce more quickly. Predators hunt prey and eat them for strength (predation). If they're strong enough, prey fend off the attacks and kill the predator. Organisms also compete for resources within their own species (competition). In particular, when two organisms wish to inhabit the same square of grass, they fight to the death to settle the dispute." << "</p></div>";
 
-        world.Resize(num_w_boxes, num_h_boxes);  
-        world.SetPopStruct_Grid(num_w_boxes, num_h_boxes);
-
-        // add predators and prey to random locations in the population
-        for (int i = 0; i < 10; i++) {
-            Predator* newPredator = new Predator(&random);
-            newPredator->mutate(random);
-            world.AddOrgAt(newPredator, random.GetUInt((num_w_boxes * num_h_boxes)-1));
+        // the default initial counts are for the 70x70 grid, and are scaled up with the area of larger ones
+        EcologyParams params;
+        double scale = std::max(1.0, (double) num_w_boxes * num_h_boxes / (70 * 70));
+        for (SpeciesParams &speciesParams : params.species) {
+            speciesParams.initialCount = (size_t) std::lround(speciesParams.initialCount * scale);
         }
-        for (int i = 0; i < 20; i++) {
-            Prey* newPrey = new Prey(&random);
-            newPrey->mutate(random);
-            world.AddOrgAt(newPrey, random.GetUInt((num_w_boxes * num_h_boxes)-1));
+        world.SetParams(params);
+        world.Initialize(num_w_boxes, num_h_boxes);
+        world.SetChangeTracking(true);
+        frames.Resize(world.GetSize());
+        PaintAndPublish(true);
+
+        simulation = std::thread([this]() { SimulationLoop(); });
+        emscripten_request_animation_frame_loop(RenderFrame, this);
+
+        EM_ASM({
+            FS.mkdir('/persist');
+            FS.mount(IDBFS, {}, '/persist');
+            FS.syncfs(true, function(err) { if (err) console.error('checkpoint storage unavailable', err); });
+        });
+    }
+
+    ~AEAnimate() {
+        {
+            std::lock_guard<std::mutex> lock(creditMutex);
+            stopping = true;
         }
+        creditsGranted.notify_one();
+        simulation.join();
     }
 
     /**
-     * Updates the ecosystem animation for each frame.
+     * Grants the simulation thread another frame's worth of updates; drawing happens in RenderFrame. At most two
+     * frames' worth are outstanding, so a simulation slower than the display stops soon after the animation does.
      */
     void DoFrame() override {
-        canvas.Clear(); 
-        world.Update();
-
-        int org_num = 0;
-        std::string color;
-
-        // iterates through population and color codes organisms by type
-        for (int x = 0; x < num_w_boxes; x++){
-            for (int y = 0; y < num_h_boxes; y++) {
-                if (world.IsOccupied(org_num)) {
-                    if (world.GetOrg(org_num).GetType() == "Predator") {color = "red";}
-                    else if (world.GetOrg(org_num).GetType() == "Prey") {color = "blue";}
-                    else {color = "black";}
-                } 
-                else { // uninhabited cells are grass
-                    color = "green"; 
-                }
-                canvas.Rect(x * RECT_SIDE, y * RECT_SIDE, RECT_SIDE, RECT_SIDE, color, color); // draws organisms
-                org_num++;
-            }
+        {
+            std::lock_guard<std::mutex> lock(creditMutex);
+            credits = std::min(credits + updatesPerFrame, 2 * updatesPerFrame);
         }
+        creditsGranted.notify_one();
     }
 };
 
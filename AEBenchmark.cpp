@@ -0,0 +1,244 @@
+/**
+ * Artificial Ecologies Assignment, CS 361
+ *
+ * Benchmarks OrgWorld::Update() across grid sizes and initial occupancies, reporting updates/s, organisms
+ * processed/s, heap allocations per update, and the time spent in each phase of the update.
+ * Build with ./compile-native.sh and run with, for example:
+ *     ./AEBenchmark --sizes 70,256,1024,4096 --occupancy 0.01,0.1,0.5 --updates 20
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "emp/base/vector.hpp"
+#include "emp/math/Random.hpp"
+#include "World.h"
+#include "CompactWorld.h"
+#include "Profile.h"
+#include "ThreadPool.h"
+
+
+// every heap allocation in the process is counted so that allocations per update can be reported; every form of
+// new and delete goes through the two below, which are kept out of line so the compiler pairs them with each other
+// rather than seeing malloc and free inlined at mismatched call sites
+static std::atomic<size_t> allocationCount{0};
+
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {return ptr;}
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {return operator new(size);}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {std::free(ptr);}
+void operator delete(void* ptr, std::size_t) noexcept {operator delete(ptr);}
+void operator delete[](void* ptr) noexcept {operator delete(ptr);}
+void operator delete[](void* ptr, std::size_t) noexcept {operator delete(ptr);}
+
+
+/**
+ * Command-line settings for a benchmark run.
+ */
+struct BenchmarkConfig {
+    emp::vector<size_t> sizes{70, 256, 1024};
+    emp::vector<double> occupancies{0.01, 0.1, 0.5};
+    size_t warmupUpdates = 2;
+    size_t numUpdates = 20;
+    int seed = 2;
+    std::string engine = "org"; // "org" (OrgWorld) or "compact" (CompactWorld)
+    size_t numThreads = 0;      // 0 runs the serial update; otherwise the tiled parallel update (compact only)
+    bool occupiedOnly = false;  // schedule only occupied cells instead of every cell
+    bool fastNeighbors = false; // draw neighbors from CompactWorld's NeighborSampler (compact only)
+    bool synchronous = false;   // run CompactWorld's synchronous update (compact only)
+    std::string simd;           // limit the synchronous update's sweeps to scalar, avx2, or avx512 (default widest)
+};
+
+
+/**
+ * Splits a comma-separated list into values.
+ * @param list The comma-separated list.
+ * @return The parsed values.
+ */
+template <typename T>
+emp::vector<T> ParseList(const std::string &list) {
+    emp::vector<T> values;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::stringstream itemStream(item);
+        T value;
+        itemStream >> value;
+        values.push_back(value);
+    }
+    return values;
+}
+
+
+/**
+ * Parses the command line into a BenchmarkConfig.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param config The configuration to fill in.
+ * @return true if every argument was understood.
+ */
+bool ParseArgs(int argc, char* argv[], BenchmarkConfig &config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--sizes") { config.sizes = ParseList<size_t>(value); }
+        else if (arg == "--occupancy") { config.occupancies = ParseList<double>(value); }
+        else if (arg == "--warmup") { config.warmupUpdates = std::strtoull(value.c_str(), nullptr, 10); }
+        else if (arg == "--updates") { config.numUpdates = std::strtoull(value.c_str(), nullptr, 10); }
+        else if (arg == "--seed") { config.seed = std::atoi(value.c_str()); }
+        else if (arg == "--engine") { config.engine = value; }
+        else if (arg == "--schedule") {
+            if (value != "full" && value != "occupied" && value != "synchronous") {
+                std::cerr << "Unknown schedule " << value << "\n";
+                return false;
+            }
+            config.occupiedOnly = value == "occupied";
+            config.synchronous = value == "synchronous";
+        }
+        else if (arg == "--simd") { config.simd = value; }
+        else if (arg == "--neighbors") {
+            if (value != "generator" && value != "sampler") {
+                std::cerr << "Unknown neighbor source " << value << "\n";
+                return false;
+            }
+            config.fastNeighbors = value == "sampler";
+        }
+        else if (arg == "--threads") { config.numThreads = std::strtoull(value.c_str(), nullptr, 10); }
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.numThreads && config.occupiedOnly) {
+        std::cerr << "--threads runs the tiled update, which schedules every cell; it cannot be combined with --schedule occupied\n";
+        return false;
+    }
+    return config.numUpdates > 0 && (config.engine == "org" || config.engine == "compact")
+        && ((config.numThreads == 0 && !config.fastNeighbors && !config.synchronous) || config.engine == "compact")
+        && (config.simd.empty() || config.simd == "scalar" || config.simd == "avx2" || config.simd == "avx512");
+}
+
+
+/**
+ * Makes a world use the parallel update on a thread pool (only CompactWorld has one).
+ */
+void SetThreadPool(CompactWorld &world, ThreadPool* threadPool) {world.SetThreadPool(threadPool);}
+void SetThreadPool(OrgWorld &, ThreadPool*) {;}
+
+
+/**
+ * Makes a world draw neighbors from its NeighborSampler (only CompactWorld has one).
+ */
+void SetFastNeighborSampling(CompactWorld &world, bool on) {world.SetFastNeighborSampling(on);}
+void SetFastNeighborSampling(OrgWorld &, bool) {;}
+
+
+/**
+ * Makes a world run the synchronous update (only CompactWorld has one).
+ */
+void SetSynchronousUpdate(CompactWorld &world, bool on) {world.SetSynchronousUpdate(on);}
+void SetSynchronousUpdate(OrgWorld &, bool) {;}
+
+
+/**
+ * Times a fixed number of updates on a square grid seeded to the given occupancy and prints one CSV row.
+ * @param size The grid side length.
+ * @param occupancy The fraction of cells initially seeded (one third predators, two thirds prey).
+ * @param config The benchmark settings.
+ * @param threadPool The pool for the parallel update, or null for the serial update.
+ */
+template <typename WORLD>
+void RunCase(size_t size, double occupancy, const BenchmarkConfig &config, ThreadPool* threadPool) {
+    // throughput is timed without the phase timers, which read the clock around every organism's phases; the
+    // breakdown comes from a second, profiled run of the same seed, which follows the same trajectory
+    auto runUpdates = [&](PhaseProfile* profile, size_t &allocations) {
+        emp::Random random{config.seed};
+        WORLD world{random};
+        world.SetOccupiedOnlyScheduling(config.occupiedOnly);
+        size_t numOrgs = (size_t) (occupancy * size * size);
+        world.Initialize(size, size, numOrgs / 3, numOrgs - numOrgs / 3);
+        if (threadPool) {SetThreadPool(world, threadPool);}
+        SetFastNeighborSampling(world, config.fastNeighbors);
+        SetSynchronousUpdate(world, config.synchronous);
+
+        for (size_t i = 0; i < config.warmupUpdates; i++) {
+            world.Update();
+        }
+
+        world.SetProfile(profile);
+        size_t allocationsBefore = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < config.numUpdates; i++) {
+            world.Update();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        allocations = allocationCount.load() - allocationsBefore;
+        world.SetProfile(nullptr);
+        return elapsed.count();
+    };
+
+    size_t allocations = 0;
+    size_t profiledAllocations = 0;
+    PhaseProfile profile;
+    double seconds = runUpdates(nullptr, allocations);
+    runUpdates(&profile, profiledAllocations);
+
+    std::cout << size << "x" << size << "," << occupancy << ","
+              << config.numUpdates / seconds << ","
+              << profile.organismsProcessed / seconds << ","
+              << (double) allocations / config.numUpdates;
+    // the parallel update times only accrual: the other phases run interleaved across threads (grids too small to
+    // tile run the serial update, which times them all)
+    bool turnsTimed = !threadPool || profile.calls[PHASE_MOVE] > 0;
+    for (int phase = 0; phase < NUM_PHASES; phase++) {
+        if (phase != PHASE_ACCRUAL && !turnsTimed) {std::cout << ",n/a";}
+        else {std::cout << "," << 1000.0 * profile.seconds[phase] / config.numUpdates;}
+    }
+    std::cout << std::endl;
+}
+
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        std::cerr << "Usage: " << argv[0] << " [--sizes 70,256,1024,4096] [--occupancy 0.01,0.1,0.5]"
+                  << " [--warmup N] [--updates N] [--seed N] [--engine org|compact] [--threads N]"
+                  << " [--schedule full|occupied|synchronous] [--neighbors generator|sampler]"
+                  << " [--simd scalar|avx2|avx512]\n";
+        return 1;
+    }
+    if (config.simd == "scalar") {Sweeps::SetLevel(SWEEP_SCALAR);}
+    else if (config.simd == "avx2") {Sweeps::SetLevel(SWEEP_AVX2);}
+    else if (config.simd == "avx512") {Sweeps::SetLevel(SWEEP_AVX512);}
+    if (config.synchronous) {std::cerr << "sweeps use " << Sweeps::LevelName(Sweeps::GetLevel()) << "\n";}
+
+    std::cout << "grid,occupancy,updates_per_s,organisms_per_s,allocations_per_update";
+    for (int phase = 0; phase < NUM_PHASES; phase++) {
+        std::cout << "," << PhaseProfile::PhaseName(phase) << "_ms_per_update";
+    }
+    std::cout << "\n";
+
+    std::unique_ptr<ThreadPool> threadPool;
+    if (config.numThreads) {threadPool.reset(new ThreadPool(config.numThreads));}
+
+    for (size_t size : config.sizes) {
+        for (double occupancy : config.occupancies) {
+            if (config.engine == "compact") {RunCase<CompactWorld>(size, occupancy, config, threadPool.get());}
+            else {RunCase<OrgWorld>(size, occupancy, config, threadPool.get());}
+        }
+    }
+    return 0;
+}
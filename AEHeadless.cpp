@@ -0,0 +1,407 @@
+/**
+ * Artificial Ecologies Assignment, CS 361
+ *
+ * Runs the artificial ecosystem natively without the web interface, so long runs are not throttled by frame pacing.
+ * Build with ./compile-native.sh and run with, for example:
+ *     ./AEHeadless --width 70 --height 70 --seed 2 --predators 10 --prey 20 --updates 1000
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "emp/math/Random.hpp"
+#include "World.h"
+#include "CompactWorld.h"
+#include "ChunkedWorld.h"
+#include "ThreadPool.h"
+#include "Checkpoint.h"
+#include "Clusters.h"
+#include "Instrument.h"
+#include "Lineage.h"
+#include "Params.h"
+#include "ReplayLog.h"
+#include "Org.h"
+#include "Predator.h"
+#include "Prey.h"
+
+
+/**
+ * Command-line settings for a headless run (defaults match the web animation).
+ */
+struct HeadlessConfig {
+    size_t width = 70;
+    size_t height = 70;
+    int seed = 2;
+    EcologyParams params; // ecological constants, including the initial predator and prey counts
+    size_t numUpdates = 1000;
+    size_t reportEvery = 0; // 0 disables per-update population reports
+    std::string engine = "org"; // "org" (OrgWorld), "compact" (CompactWorld), or "chunked" (ChunkedWorld)
+    size_t numThreads = 0; // 0 runs the serial update; otherwise the tiled parallel update (compact engine only)
+    bool occupiedOnly = false; // schedule only occupied cells instead of every cell
+    bool synchronous = false;  // run the compact engine's synchronous update
+    bool fastNeighbors = false;   // draw neighbors from the compact engine's NeighborSampler
+    bool virtualDispatch = false; // use Organism's virtual methods instead of the species kernels (org engine only)
+    std::string loadPath;      // checkpoint to resume from instead of seeding a new world
+    std::string savePath;      // where to write a checkpoint after the last update
+    std::string statsPath;     // where to stream per-update statistics (org engine only)
+    std::string lineagePath;   // where to write the living organisms' ancestry (org engine only)
+    std::string clustersPath;  // where to report per-update clusters and fronts (org engine only)
+    std::string tracePath;     // where to write a Chrome trace (instrumented builds only)
+    std::string logPath;       // where to record a replay log of every event
+};
+
+
+/**
+ * Prints usage information for the headless driver.
+ * @param program The name the program was invoked with.
+ */
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --width N       grid cells per row (default 70)\n"
+              << "  --height N      grid cells per column (default 70)\n"
+              << "  --seed N        random seed (default 2)\n"
+              << "  --predators N   initial number of predators (default 10)\n"
+              << "  --prey N        initial number of prey (default 20)\n"
+              << "  --set NAME=X    change an ecological parameter, e.g. prey.reproduction_threshold=400 (see Params.h)\n"
+              << "  --updates N     number of updates to run (default 1000)\n"
+              << "  --report N      print population counts every N updates (default 0, off)\n"
+              << "  --engine NAME   org (pointer-based OrgWorld), compact (array-based CompactWorld), or chunked\n"
+              << "                  (ChunkedWorld, for huge sparse grids; requires --schedule occupied)\n"
+              << "  --threads N     run the compact engine's tiled parallel update on N threads (default 0, serial)\n"
+              << "  --schedule NAME full (shuffle every cell), occupied (shuffle only occupied cells), or synchronous\n"
+              << "                  (every organism acts at once on the previous state; compact engine)\n"
+              << "  --neighbors NAME generator (draw each neighbor from emp::Random) or sampler (batched, compact engine)\n"
+              << "  --dispatch NAME static (inlined species kernels) or virtual (Organism's virtual methods), org engine\n"
+              << "  --load PATH     resume from a checkpoint (grid size, seed and initial counts are ignored)\n"
+              << "  --save PATH     write a checkpoint after the last update\n"
+              << "  --stats PATH    write per-update population statistics as CSV (org engine only)\n"
+              << "  --lineage PATH  track ancestry and write the living organisms' family tree as CSV (org engine only)\n"
+              << "  --clusters PATH write each species' clusters and front per update as CSV (org engine only)\n"
+              << "  --trace PATH    write event counters and timings as a Chrome trace (build with -DAE_INSTRUMENT=1)\n"
+              << "  --log PATH      record every event to a replay log, to check other builds against with AEReplay\n";
+}
+
+
+/**
+ * Parses the command line into a HeadlessConfig.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param config The configuration to fill in.
+ * @return true if every argument was understood.
+ */
+bool ParseArgs(int argc, char* argv[], HeadlessConfig &config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        if (arg == "--engine") {
+            config.engine = argv[++i];
+            continue;
+        }
+        if (arg == "--load" || arg == "--save") {
+            (arg == "--load" ? config.loadPath : config.savePath) = argv[++i];
+            continue;
+        }
+        if (arg == "--set") {
+            if (!config.params.Parse(argv[++i])) {
+                std::cerr << "Bad parameter assignment " << argv[i] << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (arg == "--stats") {
+            config.statsPath = argv[++i];
+            continue;
+        }
+        if (arg == "--lineage") {
+            config.lineagePath = argv[++i];
+            continue;
+        }
+        if (arg == "--clusters") {
+            config.clustersPath = argv[++i];
+            continue;
+        }
+        if (arg == "--trace") {
+            config.tracePath = argv[++i];
+            continue;
+        }
+        if (arg == "--log") {
+            config.logPath = argv[++i];
+            continue;
+        }
+        if (arg == "--neighbors") {
+            std::string neighbors = argv[++i];
+            if (neighbors != "generator" && neighbors != "sampler") {
+                std::cerr << "Unknown neighbor source " << neighbors << "\n";
+                return false;
+            }
+            config.fastNeighbors = neighbors == "sampler";
+            continue;
+        }
+        if (arg == "--dispatch") {
+            std::string dispatch = argv[++i];
+            if (dispatch != "static" && dispatch != "virtual") {
+                std::cerr << "Unknown dispatch " << dispatch << "\n";
+                return false;
+            }
+            config.virtualDispatch = dispatch == "virtual";
+            continue;
+        }
+        if (arg == "--schedule") {
+            std::string schedule = argv[++i];
+            if (schedule != "full" && schedule != "occupied" && schedule != "synchronous") {
+                std::cerr << "Unknown schedule " << schedule << "\n";
+                return false;
+            }
+            config.occupiedOnly = schedule == "occupied";
+            config.synchronous = schedule == "synchronous";
+            continue;
+        }
+        unsigned long long value = std::strtoull(argv[++i], nullptr, 10);
+        if (arg == "--width") { config.width = value; }
+        else if (arg == "--height") { config.height = value; }
+        else if (arg == "--seed") { config.seed = (int) value; }
+        else if (arg == "--predators") { config.params.Of(Species::Predator).initialCount = value; }
+        else if (arg == "--prey") { config.params.Of(Species::Prey).initialCount = value; }
+        else if (arg == "--updates") { config.numUpdates = value; }
+        else if (arg == "--report") { config.reportEvery = value; }
+        else if (arg == "--threads") { config.numThreads = value; }
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.width == 0 || config.height == 0) {
+        std::cerr << "Grid dimensions must be positive\n";
+        return false;
+    }
+    if (config.engine != "org" && config.engine != "compact" && config.engine != "chunked") {
+        std::cerr << "Unknown engine " << config.engine << "\n";
+        return false;
+    }
+    if (config.engine == "chunked" && !config.occupiedOnly) {
+        std::cerr << "--engine chunked schedules only occupied cells; pass --schedule occupied\n";
+        return false;
+    }
+    if (config.engine == "chunked" && (!config.loadPath.empty() || !config.savePath.empty())) {
+        std::cerr << "--engine chunked cannot --save or --load: checkpoints store every cell of the grid\n";
+        return false;
+    }
+    if (config.synchronous && (config.engine != "compact" || config.numThreads || config.width < 2)) {
+        std::cerr << "--schedule synchronous requires --engine compact without --threads, and a grid at least 2 cells wide\n";
+        return false;
+    }
+    if (config.numThreads && config.engine != "compact") {
+        std::cerr << "--threads requires --engine compact\n";
+        return false;
+    }
+    if (config.numThreads && config.occupiedOnly) {
+        std::cerr << "--threads runs the tiled update, which schedules every cell; it cannot be combined with --schedule occupied\n";
+        return false;
+    }
+    if (config.fastNeighbors && (config.engine != "compact" || config.width < 2)) {
+        std::cerr << "--neighbors sampler requires --engine compact and a grid at least 2 cells wide\n";
+        return false;
+    }
+    if (!config.tracePath.empty() && !AE_INSTRUMENT) {
+        std::cerr << "--trace requires a build with -DAE_INSTRUMENT=1\n";
+        return false;
+    }
+    if (!config.statsPath.empty() && config.engine != "org") {
+        std::cerr << "--stats requires --engine org\n";
+        return false;
+    }
+    if (!config.lineagePath.empty() && config.engine != "org") {
+        std::cerr << "--lineage requires --engine org\n";
+        return false;
+    }
+    if (!config.clustersPath.empty() && (config.engine != "org" || config.width < 3 || config.height < 3)) {
+        std::cerr << "--clusters requires --engine org and a grid at least 3 cells on each side\n";
+        return false;
+    }
+    if (!config.logPath.empty() && (config.numThreads || config.synchronous || !config.loadPath.empty())) {
+        std::cerr << "--log records asynchronous serial runs seeded from scratch; it cannot be combined with --threads,\n"
+                  << "--schedule synchronous, or --load\n";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Prints the number of predators and prey currently in the world.
+ * @param world The world to census.
+ */
+template <typename WORLD>
+void ReportPopulation(WORLD &world) {
+    std::cout << world.GetUpdate() << "," << world.CountSpecies(Species::Predator) << ","
+              << world.CountSpecies(Species::Prey) << "\n";
+}
+
+
+/**
+ * Loads or saves a world's checkpoint. Checkpoints store every cell, so ChunkedWorld has none (ParseArgs rejects
+ * --load and --save with it).
+ */
+template <typename WORLD>
+bool LoadWorld(WORLD &world, const std::string &path, std::string &error) {return LoadCheckpoint(world, path, error);}
+bool LoadWorld(ChunkedWorld &, const std::string &, std::string &error) {
+    error = "--engine chunked has no checkpoints";
+    return false;
+}
+
+template <typename WORLD>
+bool SaveWorld(WORLD &world, const std::string &path, std::string &error) {return SaveCheckpoint(world, path, error);}
+bool SaveWorld(ChunkedWorld &, const std::string &, std::string &error) {
+    error = "--engine chunked has no checkpoints";
+    return false;
+}
+
+
+/**
+ * Seeds a world (or restores it from a checkpoint) and runs it for the configured number of updates.
+ * @param world The world to run.
+ * @param config The run settings.
+ * @return true if the run completed, false if a checkpoint could not be loaded or saved.
+ */
+template <typename WORLD>
+bool RunWorld(WORLD &world, const HeadlessConfig &config) {
+    world.SetParams(config.params);
+    world.SetOccupiedOnlyScheduling(config.occupiedOnly);
+    std::string error;
+    if (config.loadPath.empty()) {
+        world.Initialize(config.width, config.height);
+    }
+    else if (!LoadWorld(world, config.loadPath, error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+
+    ReplayLog replayLog;
+    if (!config.logPath.empty()) {
+        ReplayHeader header = ReplayLog::MakeHeader(config.engine, config.params);
+        header.width = config.width;
+        header.height = config.height;
+        header.seed = config.seed;
+        header.numUpdates = config.numUpdates;
+        header.occupiedOnly = config.occupiedOnly;
+        header.fastNeighbors = config.fastNeighbors;
+        if (!replayLog.Create(config.logPath, header, error)) {
+            std::cerr << error << "\n";
+            return false;
+        }
+        world.SetReplayLog(&replayLog);
+    }
+
+    if (config.reportEvery) {
+        std::cout << "update,predators,prey\n";
+        ReportPopulation(world);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t update = 1; update <= config.numUpdates; update++) {
+        world.Update();
+        if (config.reportEvery && update % config.reportEvery == 0) {
+            ReportPopulation(world);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cerr << config.numUpdates << " updates on a " << world.GetWidth() << "x" << world.GetHeight() << " grid in "
+              << elapsed.count() << " s (" << config.numUpdates / elapsed.count() << " updates/s)\n";
+
+    if (!config.logPath.empty()) {
+        world.SetReplayLog(nullptr);
+        if (!replayLog.Close(error)) {
+            std::cerr << error << "\n";
+            return false;
+        }
+        std::cerr << replayLog.GetNumEvents() << " events logged to " << config.logPath << "\n";
+    }
+    if (!config.savePath.empty() && !SaveWorld(world, config.savePath, error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    if (!config.tracePath.empty()) {
+        emp::vector<size_t> totals = Instrument::Totals();
+        for (size_t c = 0; c < NUM_COUNTERS; c++) {
+            std::cerr << Instrument::CounterName(c) << ": " << totals[c] << "\n";
+        }
+        if (!Instrument::WriteChromeTrace(config.tracePath, error)) {
+            std::cerr << error << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char* argv[]) {
+    HeadlessConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    emp::Random random{config.seed};
+    if (config.engine == "chunked") {
+        ChunkedWorld world{random};
+        if (!RunWorld(world, config)) {return 1;}
+        std::cerr << world.GetNumChunks() << " chunks allocated, " << world.GetMemoryBytes() / (1024 * 1024)
+                  << " MiB of grid storage\n";
+    }
+    else if (config.engine == "compact") {
+        CompactWorld world{random};
+        world.SetFastNeighborSampling(config.fastNeighbors);
+        world.SetSynchronousUpdate(config.synchronous);
+        std::unique_ptr<ThreadPool> threadPool;
+        if (config.numThreads) {
+            threadPool.reset(new ThreadPool(config.numThreads));
+            world.SetThreadPool(threadPool.get());
+        }
+        if (!RunWorld(world, config)) {return 1;}
+    }
+    else {
+        Lineage lineage;
+        OrgWorld world{random};
+        world.SetVirtualDispatch(config.virtualDispatch);
+        if (!config.lineagePath.empty()) {
+            world.SetLineage(&lineage);
+        }
+        Clusters clusters;
+        if (!config.clustersPath.empty()) {
+            if (!clusters.OpenReport(config.clustersPath)) {
+                std::cerr << "cannot open " << config.clustersPath << " for writing\n";
+                return 1;
+            }
+            world.SetClusters(&clusters);
+        }
+        StatsWriter statsWriter;
+        if (!config.statsPath.empty()) {
+            if (!statsWriter.Open(config.statsPath)) {
+                std::cerr << "cannot open " << config.statsPath << " for writing\n";
+                return 1;
+            }
+            world.SetStatsWriter(&statsWriter);
+        }
+        if (!RunWorld(world, config)) {return 1;}
+        std::cerr << world.GetPool().GetNumCreated() << " organisms created with "
+                  << world.GetPool().GetAllocationsAvoided() << " heap allocations avoided\n";
+        if (!config.lineagePath.empty()) {
+            std::string error;
+            if (!lineage.Write(config.lineagePath, error)) {
+                std::cerr << error << "\n";
+                return 1;
+            }
+            std::cerr << lineage.GetNumBirths() << " organisms tracked, " << lineage.GetNumNodes()
+                      << " kept in the family tree of " << lineage.GetNumLiving() << " living ("
+                      << lineage.GetMemoryBytes() / 1024 << " KiB)\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * Artificial Ecologies Assignment, CS 361
+ *
+ * Checks that offspring mutations have each species' configured distribution and that siblings mutate
+ * independently, through both Organism's virtual methods and the species kernels. Exits with 1 if a check fails.
+ * Build with ./compile-native.sh and run with, for example:
+ *     ./AEMutationTest --pairs 100000 --seed 2
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "emp/math/Random.hpp"
+#include "Org.h"
+#include "OrganismPool.h"
+#include "Params.h"
+#include "Predator.h"
+#include "Prey.h"
+#include "Species.h"
+#include "SpeciesKernels.h"
+
+
+/**
+ * Command-line settings for the mutation test.
+ */
+struct MutationTestConfig {
+    size_t numPairs = 100000; // sibling pairs drawn per species and dispatch
+    int seed = 2;
+};
+
+
+/**
+ * Prints usage information for the mutation test.
+ * @param program The name the program was invoked with.
+ */
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --pairs N       sibling pairs to draw for each species and dispatch (default 100000)\n"
+              << "  --seed N        random seed (default 2)\n";
+}
+
+
+/**
+ * Parses the command line into a configuration.
+ * @param argc Argument count from main.
+ * @param argv Argument values from main.
+ * @param config The configuration to fill in.
+ * @return true if every argument was understood.
+ */
+bool ParseArgs(int argc, char* argv[], MutationTestConfig &config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        if (arg == "--pairs") {
+            config.numPairs = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed") {
+            config.seed = std::atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (config.numPairs < 100) {
+        std::cerr << "--pairs must be at least 100\n";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Has a parent produce pairs of siblings and checks their mutations: the mean and standard deviation against the
+ * species' mutationSigma, and the correlation between siblings, each to within five standard errors.
+ * @param species The species to test.
+ * @param virtualDispatch Reproduce through Organism::CheckReproduction rather than the species kernels.
+ * @param random The generator the organisms draw from.
+ * @param params The ecological parameters.
+ * @param numPairs The number of sibling pairs.
+ * @return true if every check passed.
+ */
+bool CheckMutations(Species species, bool virtualDispatch, emp::Random &random, const EcologyParams &params,
+                    size_t numPairs) {
+    OrganismPool pool;
+    Organism* parent = nullptr;
+    DispatchSpecies(species, [&](auto tag) {
+        parent = pool.New<typename SpeciesClass<decltype(tag)::value>::type>(&random);
+    });
+    double sigma = params.Of(species).mutationSigma;
+    double threshold = params.Of(species).reproductionThreshold;
+
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    double sumProducts = 0.0; // of the two siblings' mutations
+    for (size_t i = 0; i < numPairs; i++) {
+        parent->SetPoints(2 * threshold);
+        double mutation[2];
+        for (double &delta : mutation) {
+            emp::Ptr<Organism> offspring = virtualDispatch ? parent->CheckReproduction(pool, params)
+                                                           : Reproduce(*parent, pool, random, params);
+            delta = offspring->GetStrength() - parent->GetStrength();
+            pool.Delete(offspring.Raw());
+        }
+        sum += mutation[0] + mutation[1];
+        sumSquares += mutation[0] * mutation[0] + mutation[1] * mutation[1];
+        sumProducts += mutation[0] * mutation[1];
+    }
+    pool.Delete(parent);
+
+    double count = 2.0 * numPairs;
+    double mean = sum / count;
+    double sd = std::sqrt(sumSquares / count - mean * mean);
+    double correlation = (sumProducts / numPairs - mean * mean) / (sd * sd);
+
+    bool meanOk = std::abs(mean) <= 5 * sigma / std::sqrt(count);
+    bool sdOk = std::abs(sd / sigma - 1) <= 5 / std::sqrt(2 * count);
+    bool independentOk = std::abs(correlation) <= 5 / std::sqrt((double) numPairs);
+    std::cout << SpeciesName(species) << "," << (virtualDispatch ? "virtual" : "static") << "," << sigma << ","
+              << mean << "," << sd << "," << correlation << ","
+              << (meanOk && sdOk && independentOk ? "ok" : "FAIL") << "\n";
+    return meanOk && sdOk && independentOk;
+}
+
+
+int main(int argc, char* argv[]) {
+    MutationTestConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    emp::Random random{config.seed};
+    EcologyParams params;
+    bool passed = true;
+    std::cout << "species,dispatch,sigma,mean,sd,sibling_correlation,result\n";
+    for (size_t s = 0; s < NUM_SPECIES; s++) {
+        for (bool virtualDispatch : {false, true}) {
+            passed &= CheckMutations((Species) s, virtualDispatch, random, params, config.numPairs);
+        }
+    }
+    return passed ? 0 : 1;
+}
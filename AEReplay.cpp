@@ -0,0 +1,170 @@
+/**
+ * Artificial Ecologies Assignment, CS 361
+ *
+ * Replays a run recorded with AEHeadless --log against this build and reports the first event where the two runs
+ * differ, so a change to the update loop can be checked for leaving trajectories untouched.
+ * Build with ./compile-native.sh and run with, for example:
+ *     ./AEHeadless --width 70 --height 70 --updates 1000 --log before.log
+ *     (rebuild with the change)
+ *     ./AEReplay before.log
+ * Passing --engine replays the log on another engine, e.g. a log from the org engine on the compact engine.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "emp/math/Random.hpp"
+#include "World.h"
+#include "CompactWorld.h"
+#include "ChunkedWorld.h"
+#include "ReplayLog.h"
+
+
+/**
+ * Command-line settings for a replay.
+ */
+struct ReplayConfig {
+    std::string logPath;
+    std::string engine;           // empty replays on the engine the log was recorded with
+    bool virtualDispatch = false; // use Organism's virtual methods instead of the species kernels (org engine only)
+};
+
+
+/**
+ * Prints usage information for the replay checker.
+ * @param program The name the program was invoked with.
+ */
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " LOG [options]\n"
+              << "  --engine NAME   replay on org, compact, or chunked instead of the engine that recorded the log\n"
+              << "  --dispatch NAME static (inlined species kernels) or virtual (Organism's virtual methods), org engine\n";
+}
+
+
+/**
+ * Parses the command line into a ReplayConfig.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param config The configuration to fill in.
+ * @return true if every argument was understood.
+ */
+bool ParseArgs(int argc, char* argv[], ReplayConfig &config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            if (!config.logPath.empty()) {
+                std::cerr << "Only one log can be replayed at a time\n";
+                return false;
+            }
+            config.logPath = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--engine") { config.engine = value; }
+        else if (arg == "--dispatch" && (value == "static" || value == "virtual")) {
+            config.virtualDispatch = value == "virtual";
+        }
+        else {
+            std::cerr << "Unknown option " << arg << " " << value << "\n";
+            return false;
+        }
+    }
+    if (config.logPath.empty()) {
+        std::cerr << "No log given\n";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Runs a world from the setup in the log's header, checking each event against the log, until the run ends or
+ * first differs from the log.
+ * @param world The world to run, already configured for its engine.
+ * @param replayLog The opened log.
+ * @return true if the run finished without an error (whether or not it diverged).
+ */
+template <typename WORLD>
+bool Replay(WORLD &world, ReplayLog &replayLog) {
+    const ReplayHeader &header = replayLog.GetHeader();
+    world.SetParams(header.params);
+    world.SetOccupiedOnlyScheduling(header.occupiedOnly);
+    world.Initialize(header.width, header.height);
+    world.SetReplayLog(&replayLog);
+    for (size_t update = 1; update <= header.numUpdates && !replayLog.HasDiverged(); update++) {
+        world.Update();
+    }
+    world.SetReplayLog(nullptr);
+    std::string error;
+    if (!replayLog.Close(error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+
+int main(int argc, char* argv[]) {
+    ReplayConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    ReplayLog replayLog;
+    std::string error;
+    if (!replayLog.Open(config.logPath, error)) {
+        std::cerr << error << "\n";
+        return 2;
+    }
+    const ReplayHeader &header = replayLog.GetHeader();
+    std::string engine = config.engine.empty() ? std::string(header.engine) : config.engine;
+    std::cerr << "replaying " << header.numEvents << " events over " << header.numUpdates << " updates of a "
+              << header.width << "x" << header.height << " grid (seed " << header.seed << ", recorded on "
+              << header.engine << ") on " << engine << "\n";
+
+    if (header.fastNeighbors && engine != "compact") {
+        std::cerr << "the log draws neighbors from the compact engine's sampler, so it can only replay on compact\n";
+        return 2;
+    }
+    if (engine == "chunked" && !header.occupiedOnly) {
+        std::cerr << "the chunked engine only replays logs recorded with --schedule occupied\n";
+        return 2;
+    }
+
+    emp::Random random{(int) header.seed};
+    bool ok;
+    if (engine == "org") {
+        OrgWorld world{random};
+        world.SetVirtualDispatch(config.virtualDispatch);
+        ok = Replay(world, replayLog);
+    }
+    else if (engine == "compact") {
+        CompactWorld world{random};
+        world.SetFastNeighborSampling(header.fastNeighbors);
+        ok = Replay(world, replayLog);
+    }
+    else if (engine == "chunked") {
+        ChunkedWorld world{random};
+        ok = Replay(world, replayLog);
+    }
+    else {
+        std::cerr << "Unknown engine " << engine << "\n";
+        return 2;
+    }
+    if (!ok) {
+        return 2;
+    }
+
+    if (replayLog.HasDiverged()) {
+        std::cout << "diverged at event " << replayLog.GetDivergenceIndex() << " (update "
+                  << replayLog.GetDivergenceUpdate() << ")\n" << replayLog.DescribeDivergence();
+        return 1;
+    }
+    std::cout << "identical: " << replayLog.GetNumEvents() << " events\n";
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * Artificial Ecologies Assignment, CS 361
+ *
+ * Runs a parameter sweep: many independent replicate worlds, one per (parameter combination, seed), spread across
+ * every core, with the population counts of all of them written to one CSV file.
+ * Build with ./compile-native.sh and run with, for example:
+ *     ./AESweep --vary prey.reproduction_threshold=300,400,500 --vary hunt_probes=2,4 --replicates 50 --out sweep.csv
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "emp/base/vector.hpp"
+#include "emp/math/Random.hpp"
+#include "World.h"
+#include "CompactWorld.h"
+#include "Params.h"
+#include "ThreadPool.h"
+
+
+/**
+ * One swept parameter and the values it takes.
+ */
+struct SweepAxis {
+    std::string name;
+    emp::vector<double> values;
+};
+
+
+/**
+ * Command-line settings for a sweep.
+ */
+struct SweepConfig {
+    size_t width = 70;
+    size_t height = 70;
+    size_t numUpdates = 1000;
+    size_t sampleEvery = 0;   // 0 records only the final update of each replicate
+    size_t numReplicates = 10;
+    int firstSeed = 1;        // replicates use seeds firstSeed, firstSeed + 1, ...
+    std::string engine = "compact"; // "org" (OrgWorld) or "compact" (CompactWorld)
+    bool occupiedOnly = false; // schedule only occupied cells instead of every cell
+    bool synchronous = false;  // run CompactWorld's synchronous update
+    size_t numThreads = 0;     // 0 uses one per hardware thread
+    std::string outPath;       // empty writes to standard output
+    EcologyParams baseParams;  // parameters shared by every replicate, before the swept ones are applied
+    emp::vector<SweepAxis> axes;
+
+
+    /**
+     * @return The number of parameter combinations (the product of the axes' sizes).
+     */
+    size_t NumPoints() const {
+        size_t points = 1;
+        for (const SweepAxis &axis : axes) {
+            points *= axis.values.size();
+        }
+        return points;
+    }
+
+
+    /**
+     * Gets the parameters for one combination, with the first axis varying slowest.
+     * @param point The combination's index in [0, NumPoints()).
+     * @return The base parameters with that combination's values applied.
+     */
+    EcologyParams ParamsAt(size_t point) const {
+        EcologyParams params = baseParams;
+        for (size_t a = axes.size(); a-- > 0;) {
+            params.Set(axes[a].name, axes[a].values[point % axes[a].values.size()]);
+            point /= axes[a].values.size();
+        }
+        return params;
+    }
+};
+
+
+/**
+ * Prints usage information for the sweep driver.
+ * @param program The name the program was invoked with.
+ */
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --width N        grid cells per row (default 70)\n"
+              << "  --height N       grid cells per column (default 70)\n"
+              << "  --updates N      updates per replicate (default 1000)\n"
+              << "  --sample N       record counts every N updates (default 0, final update only)\n"
+              << "  --replicates N   seeds per parameter combination (default 10)\n"
+              << "  --seed N         first seed (default 1)\n"
+              << "  --engine NAME    org (pointer-based OrgWorld) or compact (array-based CompactWorld, default)\n"
+              << "  --schedule NAME  full (shuffle every cell), occupied (shuffle only occupied cells), or synchronous\n"
+              << "                   (every organism acts at once; compact engine)\n"
+              << "  --threads N      worker threads (default 0, one per hardware thread)\n"
+              << "  --set NAME=X     fix an ecological parameter for every replicate (see Params.h)\n"
+              << "  --vary NAME=X,Y  sweep a parameter over the listed values; repeat to sweep all combinations\n"
+              << "  --out PATH       CSV file to write (default standard output)\n";
+}
+
+
+/**
+ * Parses the command line into a SweepConfig.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param config The configuration to fill in.
+ * @return true if every argument was understood.
+ */
+bool ParseArgs(int argc, char* argv[], SweepConfig &config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--engine") { config.engine = value; }
+        else if (arg == "--schedule") {
+            if (value != "full" && value != "occupied" && value != "synchronous") {
+                std::cerr << "Unknown schedule " << value << "\n";
+                return false;
+            }
+            config.occupiedOnly = value == "occupied";
+            config.synchronous = value == "synchronous";
+        }
+        else if (arg == "--out") { config.outPath = value; }
+        else if (arg == "--set") {
+            if (!config.baseParams.Parse(value)) {
+                std::cerr << "Bad parameter assignment " << value << "\n";
+                return false;
+            }
+        }
+        else if (arg == "--vary") {
+            SweepAxis axis;
+            size_t equals = value.find('=');
+            double current;
+            axis.name = value.substr(0, equals);
+            if (equals == std::string::npos || !config.baseParams.Get(axis.name, current)) {
+                std::cerr << "Bad parameter sweep " << value << "\n";
+                return false;
+            }
+            std::stringstream stream(value.substr(equals + 1));
+            std::string item;
+            while (std::getline(stream, item, ',')) {
+                char* end = nullptr;
+                double number = std::strtod(item.c_str(), &end);
+                if (item.empty() || *end != '\0') {
+                    std::cerr << "Bad value '" << item << "' for " << axis.name << "\n";
+                    return false;
+                }
+                axis.values.push_back(number);
+            }
+            if (axis.values.empty()) {
+                std::cerr << "No values given for " << axis.name << "\n";
+                return false;
+            }
+            config.axes.push_back(axis);
+        }
+        else {
+            unsigned long long number = std::strtoull(value.c_str(), nullptr, 10);
+            if (arg == "--width") { config.width = number; }
+            else if (arg == "--height") { config.height = number; }
+            else if (arg == "--updates") { config.numUpdates = number; }
+            else if (arg == "--sample") { config.sampleEvery = number; }
+            else if (arg == "--replicates") { config.numReplicates = number; }
+            else if (arg == "--seed") { config.firstSeed = (int) number; }
+            else if (arg == "--threads") { config.numThreads = number; }
+            else {
+                std::cerr << "Unknown option " << arg << "\n";
+                return false;
+            }
+        }
+    }
+    if (config.width == 0 || config.height == 0) {
+        std::cerr << "Grid dimensions must be positive\n";
+        return false;
+    }
+    if (config.engine != "org" && config.engine != "compact") {
+        std::cerr << "Unknown engine " << config.engine << "\n";
+        return false;
+    }
+    if (config.synchronous && (config.engine != "compact" || config.width < 2)) {
+        std::cerr << "--schedule synchronous requires --engine compact and a grid at least 2 cells wide\n";
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Makes a world run the synchronous update (only CompactWorld has one).
+ */
+void SetSynchronousUpdate(CompactWorld &world, bool on) {world.SetSynchronousUpdate(on);}
+void SetSynchronousUpdate(OrgWorld &, bool) {;}
+
+
+/**
+ * Runs one replicate world to completion and formats its CSV rows. Each replicate owns its generator and world,
+ * so replicates can run on any thread in any order and still give the same rows.
+ * @param config The sweep settings.
+ * @param point The parameter combination to run.
+ * @param seed The replicate's seed.
+ * @return The replicate's rows.
+ */
+template <typename WORLD>
+std::string RunReplicate(const SweepConfig &config, size_t point, int seed) {
+    emp::Random random{seed};
+    WORLD world{random};
+    EcologyParams params = config.ParamsAt(point);
+    world.SetParams(params);
+    world.SetOccupiedOnlyScheduling(config.occupiedOnly);
+    SetSynchronousUpdate(world, config.synchronous);
+    world.Initialize(config.width, config.height);
+
+    std::ostringstream prefix;
+    prefix << point << "," << seed;
+    for (const SweepAxis &axis : config.axes) {
+        double value;
+        params.Get(axis.name, value);
+        prefix << "," << value;
+    }
+
+    std::ostringstream rows;
+    for (size_t update = 1; update <= config.numUpdates; update++) {
+        // an empty world stays empty, so its remaining samples are all zero
+        if (!world.IsEmpty()) {world.Update();}
+        bool sampled = config.sampleEvery ? update % config.sampleEvery == 0 : update == config.numUpdates;
+        if (sampled) {
+            rows << prefix.str() << "," << update << "," << world.CountSpecies(Species::Predator) << ","
+                 << world.CountSpecies(Species::Prey) << "\n";
+        }
+    }
+    return rows.str();
+}
+
+
+int main(int argc, char* argv[]) {
+    SweepConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream outFile;
+    if (!config.outPath.empty()) {
+        outFile.open(config.outPath);
+        if (!outFile) {
+            std::cerr << "cannot open " << config.outPath << " for writing\n";
+            return 1;
+        }
+    }
+    std::ostream &out = config.outPath.empty() ? std::cout : outFile;
+
+    size_t numJobs = config.NumPoints() * config.numReplicates;
+    emp::vector<std::string> results(numJobs);
+    ThreadPool threadPool(config.numThreads);
+
+    auto start = std::chrono::steady_clock::now();
+    threadPool.ParallelFor(numJobs, [&](size_t job, size_t) {
+        size_t point = job / config.numReplicates;
+        int seed = config.firstSeed + (int) (job % config.numReplicates);
+        if (config.engine == "compact") {results[job] = RunReplicate<CompactWorld>(config, point, seed);}
+        else {results[job] = RunReplicate<OrgWorld>(config, point, seed);}
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // rows are written in job order, so the file doesn't depend on how the jobs were scheduled
+    out << "point,seed";
+    for (const SweepAxis &axis : config.axes) {
+        out << "," << axis.name;
+    }
+    out << ",update,predators,prey\n";
+    for (const std::string &rows : results) {
+        out << rows;
+    }
+
+    std::cerr << numJobs << " replicates of " << config.numUpdates << " updates on " << threadPool.GetNumThreads()
+              << " threads in " << elapsed.count() << " s\n";
+    return out ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "emp/math/Random.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include "Org.h"
+
+
+/**
+ * Binary snapshots of a world (OrgWorld or CompactWorld). A checkpoint file holds, in native little-endian order:
+ *
+ *     CheckpointHeader
+ *     the raw bytes of the shared emp::Random
+ *     one byte per cell: 0 if empty, otherwise 1 + the occupant's Species
+ *     one double per cell: reproduction points
+ *     one double per cell: strength
+ *
+ * with every section starting on an 8-byte boundary, so a memory-mapped file can be read in place. Restoring a
+ * checkpoint and continuing gives the same run as never having stopped, except with OrgWorld's occupied-only
+ * scheduling, whose list of occupied cells is rebuilt in position order.
+ */
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t rngSize;
+    uint64_t width;
+    uint64_t height;
+    uint64_t update;
+    uint64_t rngOffset;
+    uint64_t cellsOffset;
+    uint64_t pointsOffset;
+    uint64_t strengthOffset;
+    uint64_t fileSize;
+};
+
+static const char CHECKPOINT_MAGIC[8] = {'A', 'E', 'C', 'K', 'P', 'T', '\0', '\0'};
+static const uint32_t CHECKPOINT_VERSION = 1;
+
+// the generator is saved byte for byte, which is only meaningful for a plain-data type
+static_assert(std::is_trivially_copyable<emp::Random>::value, "checkpoints require a trivially copyable emp::Random");
+
+
+/**
+ * Rounds an offset up to the next multiple of 8.
+ */
+inline uint64_t AlignCheckpointOffset(uint64_t offset) {return (offset + 7) & ~uint64_t(7);}
+
+
+/**
+ * Checks that a grid's checkpoint size can be computed without overflow: each cell takes a species byte and two
+ * doubles, after a header and generator of a few kilobytes at most.
+ * @param width The grid width.
+ * @param height The grid height.
+ * @return true if the dimensions are positive and the file size fits in 64 bits.
+ */
+inline bool CheckpointDimensionsFit(uint64_t width, uint64_t height) {
+    const uint64_t maxCells = (UINT64_MAX - (1 << 16)) / (1 + 2 * sizeof(double));
+    return width > 0 && height > 0 && width <= maxCells / height;
+}
+
+
+/**
+ * Lays out the sections of a checkpoint for a grid of the given size, which must pass CheckpointDimensionsFit.
+ * @param width The grid width.
+ * @param height The grid height.
+ * @return A header with every field but update filled in.
+ */
+inline CheckpointHeader MakeCheckpointHeader(uint64_t width, uint64_t height) {
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.rngSize = sizeof(emp::Random);
+    header.width = width;
+    header.height = height;
+    uint64_t numCells = width * height;
+    header.rngOffset = AlignCheckpointOffset(sizeof(CheckpointHeader));
+    header.cellsOffset = AlignCheckpointOffset(header.rngOffset + header.rngSize);
+    header.pointsOffset = AlignCheckpointOffset(header.cellsOffset + numCells);
+    header.strengthOffset = header.pointsOffset + numCells * sizeof(double);
+    header.fileSize = header.strengthOffset + numCells * sizeof(double);
+    return header;
+}
+
+
+/**
+ * Writes a world's full state to a checkpoint file.
+ * @param world The world to save.
+ * @param path Where to write the checkpoint.
+ * @param error Set to a description of the problem if saving fails.
+ * @return true if the checkpoint was written.
+ */
+template <typename WORLD>
+bool SaveCheckpoint(WORLD &world, const std::string &path, std::string &error) {
+    CheckpointHeader header = MakeCheckpointHeader(world.GetWidth(), world.GetHeight());
+    header.update = world.GetUpdate();
+    uint64_t numCells = header.width * header.height;
+
+    // the file is assembled in memory and written with one call
+    std::string buffer(header.fileSize, '\0');
+    char* data = &buffer[0];
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + header.rngOffset, &world.GetRandom(), sizeof(emp::Random));
+    uint8_t* cells = reinterpret_cast<uint8_t*>(data + header.cellsOffset);
+    double* points = reinterpret_cast<double*>(data + header.pointsOffset);
+    double* strength = reinterpret_cast<double*>(data + header.strengthOffset);
+    for (uint64_t i = 0; i < numCells; i++) {
+        if (world.IsOccupied(i)) {
+            cells[i] = 1 + (uint8_t) world.GetSpeciesAt(i);
+            points[i] = world.GetPointsAt(i);
+            strength[i] = world.GetStrengthAt(i);
+        }
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+    bool written = std::fwrite(data, 1, buffer.size(), file) == buffer.size();
+    written = (std::fclose(file) == 0) && written;
+    if (!written) {error = "failed writing " + path;}
+    return written;
+}
+
+
+/**
+ * A read-only memory mapping of a checkpoint file, validated on open.
+ */
+class CheckpointFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    public:
+        CheckpointFile() {;}
+        ~CheckpointFile() {Close();}
+        CheckpointFile(const CheckpointFile &) = delete;
+        CheckpointFile &operator=(const CheckpointFile &) = delete;
+
+
+        /**
+         * Maps a checkpoint file and checks that its header is consistent.
+         * @param path The checkpoint file.
+         * @param error Set to a description of the problem if the file can't be used.
+         * @return true if the file was mapped and is a valid checkpoint.
+         */
+        bool Open(const std::string &path, std::string &error) {
+            Close();
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                error = "cannot open " + path;
+                return false;
+            }
+            struct stat info;
+            if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(CheckpointHeader)) {
+                close(fd);
+                error = path + " is too short to be a checkpoint";
+                return false;
+            }
+            size = info.st_size;
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapping == MAP_FAILED) {
+                size = 0;
+                error = "cannot map " + path;
+                return false;
+            }
+            data = static_cast<const char*>(mapping);
+
+            const CheckpointHeader &header = GetHeader();
+            bool fits = CheckpointDimensionsFit(header.width, header.height);
+            CheckpointHeader expected = MakeCheckpointHeader(fits ? header.width : 1, fits ? header.height : 1);
+            if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {error = path + " is not a checkpoint";}
+            else if (header.version != CHECKPOINT_VERSION) {error = path + " has an unsupported checkpoint version";}
+            else if (header.rngSize != expected.rngSize) {error = path + " was written with a different emp::Random";}
+            else if (!fits) {error = path + " has impossible grid dimensions";}
+            else if (header.fileSize != expected.fileSize
+                     || header.cellsOffset != expected.cellsOffset || header.pointsOffset != expected.pointsOffset
+                     || header.strengthOffset != expected.strengthOffset || header.fileSize != size) {
+                error = path + " has an inconsistent layout";
+            }
+            else {
+                return true;
+            }
+            Close();
+            return false;
+        }
+
+
+        void Close() {
+            if (data) {munmap(const_cast<char*>(data), size);}
+            data = nullptr;
+            size = 0;
+        }
+
+        const CheckpointHeader &GetHeader() const {return *reinterpret_cast<const CheckpointHeader*>(data);}
+        const void* GetRandomBytes() const {return data + GetHeader().rngOffset;}
+        const uint8_t* GetCells() const {return reinterpret_cast<const uint8_t*>(data + GetHeader().cellsOffset);}
+        const double* GetPoints() const {return reinterpret_cast<const double*>(data + GetHeader().pointsOffset);}
+        const double* GetStrength() const {return reinterpret_cast<const double*>(data + GetHeader().strengthOffset);}
+};
+
+
+/**
+ * Replaces a world's state (grid, organisms, update number, and shared generator) with a checkpoint's.
+ * @param world The world to restore into.
+ * @param path The checkpoint file.
+ * @param error Set to a description of the problem if loading fails.
+ * @return true if the world was restored; on failure the world is unchanged.
+ */
+template <typename WORLD>
+bool LoadCheckpoint(WORLD &world, const std::string &path, std::string &error) {
+    CheckpointFile file;
+    if (!file.Open(path, error)) {
+        return false;
+    }
+    const CheckpointHeader &header = file.GetHeader();
+    const uint8_t* cells = file.GetCells();
+    for (uint64_t i = 0; i < header.width * header.height; i++) {
+        if (cells[i] > NUM_SPECIES) { // 0 is an empty cell, otherwise 1 + the species
+            error = path + " contains an unknown species";
+            return false;
+        }
+    }
+
+    world.Restore(header.width, header.height, header.update, cells, file.GetPoints(), file.GetStrength());
+    std::memcpy(&world.GetRandom(), file.GetRandomBytes(), sizeof(emp::Random));
+    return true;
+}
+#endif
@@ -0,0 +1,521 @@
+#ifndef CHUNKED_WORLD_H
+#define CHUNKED_WORLD_H
+
+#include "emp/base/vector.hpp"
+#include "emp/math/Random.hpp"
+#include <algorithm>
+#include <cstdint>
+#include "Instrument.h"
+#include "Org.h"
+#include "Params.h"
+#include "Profile.h"
+#include "ReplayLog.h"
+#include "Scheduler.h"
+#include "SpeciesKernels.h"
+
+
+/**
+ * A world for very large, mostly empty grids. The grid is cut into CHUNK_SIDE x CHUNK_SIDE chunks, each holding
+ * its cells' occupancy bits, species, points, and strength; a chunk is allocated when an organism first lands in
+ * it and freed once it is empty at the start of an update, so memory grows with the occupied area rather than
+ * the grid. The only per-cell-of-grid cost is one pointer per chunk in a dense table.
+ *
+ * Cells are addressed by column and row, so a neighbor on the torus costs a wrap and a table lookup, with no
+ * division. Every update schedules only the occupied cells, visited in the same order CompactWorld's occupied-
+ * only schedule uses, and applies the same rules with the same draws, so for grids both can hold the two worlds
+ * follow the same trajectory.
+ */
+class ChunkedWorld {
+    static constexpr uint32_t CHUNK_SHIFT = 6;
+    static constexpr uint32_t CHUNK_SIDE = 1 << CHUNK_SHIFT;
+    static constexpr uint32_t CHUNK_MASK = CHUNK_SIDE - 1;
+    static constexpr size_t CHUNK_CELLS = CHUNK_SIDE * CHUNK_SIDE;
+    static constexpr size_t MAX_SPARE_CHUNKS = 64; // empty chunks kept for reuse instead of freed
+
+    struct Chunk {
+        uint64_t occupied[CHUNK_SIDE]; // one word per row of the chunk
+        Species species[CHUNK_CELLS];
+        double points[CHUNK_CELLS];
+        double strength[CHUNK_CELLS];
+        size_t count;                  // occupied cells
+    };
+
+    /**
+     * A cell, by column and row.
+     */
+    struct Cell {
+        uint32_t x;
+        uint32_t y;
+    };
+
+    emp::Random &random;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t update = 0;
+    size_t chunksX = 0; // chunks per row of the grid
+    size_t chunksY = 0; // chunks per column of the grid
+
+    emp::vector<Chunk*> chunks;                // dense table of every chunk position, null where unallocated
+    emp::vector<size_t> liveChunks;            // ids of allocated chunks
+    emp::vector<Chunk*> spareChunks;           // allocated but unused, ready for reuse
+    size_t speciesCount[NUM_SPECIES] = {};
+
+    EcologyParams params;
+    PhaseProfile* profile = nullptr;
+    Scheduler scheduler;
+    ReplayLog* replayLog = nullptr; // records or checks every event when set
+    emp::vector<size_t> occupiedCells; // scratch list of occupied cells, packed as in Pack()
+    emp::vector<size_t> chunkRow;      // scratch list of the live chunk columns in one row of chunks
+
+
+    static size_t Pack(Cell cell) {return (size_t) cell.y << 32 | cell.x;}
+    static Cell Unpack(size_t packed) {return {(uint32_t) packed, (uint32_t) (packed >> 32)};}
+    size_t IndexOf(Cell cell) const {return (size_t) cell.y * width + cell.x;}
+    static size_t LocalIndex(Cell cell) {return (cell.y & CHUNK_MASK) * CHUNK_SIDE + (cell.x & CHUNK_MASK);}
+
+    size_t ChunkId(Cell cell) const {return (cell.y >> CHUNK_SHIFT) * chunksX + (cell.x >> CHUNK_SHIFT);}
+    Chunk* ChunkOf(Cell cell) const {return chunks[ChunkId(cell)];}
+
+
+    /**
+     * Gets the chunk holding a cell, allocating it if needed.
+     */
+    Chunk &ChunkFor(Cell cell) {
+        size_t id = ChunkId(cell);
+        if (chunks[id] == nullptr) {
+            Chunk* chunk;
+            if (spareChunks.empty()) {
+                chunk = new Chunk;
+            }
+            else {
+                chunk = spareChunks.back();
+                spareChunks.pop_back();
+            }
+            std::fill(chunk->occupied, chunk->occupied + CHUNK_SIDE, 0);
+            chunk->count = 0;
+            chunks[id] = chunk;
+            liveChunks.push_back(id);
+        }
+        return *chunks[id];
+    }
+
+
+    /**
+     * Returns the chunks that have emptied to the spare list (or frees them if it is full), and sorts the rest
+     * into row-major order.
+     */
+    void ReleaseEmptyChunks() {
+        size_t kept = 0;
+        for (size_t id : liveChunks) {
+            if (chunks[id]->count) {
+                liveChunks[kept++] = id;
+                continue;
+            }
+            if (spareChunks.size() < MAX_SPARE_CHUNKS) {spareChunks.push_back(chunks[id]);}
+            else {delete chunks[id];}
+            chunks[id] = nullptr;
+        }
+        liveChunks.resize(kept);
+        std::sort(liveChunks.begin(), liveChunks.end());
+    }
+
+
+    /**
+     * Frees every chunk, live or spare.
+     */
+    void FreeChunks() {
+        for (size_t id : liveChunks) {
+            delete chunks[id];
+            chunks[id] = nullptr;
+        }
+        for (Chunk* chunk : spareChunks) {
+            delete chunk;
+        }
+        liveChunks.clear();
+        spareChunks.clear();
+    }
+
+
+    bool Occupied(Cell cell) const {
+        const Chunk* chunk = ChunkOf(cell);
+        return chunk && ((chunk->occupied[cell.y & CHUNK_MASK] >> (cell.x & CHUNK_MASK)) & 1);
+    }
+
+
+    /**
+     * Places an organism in a cell, replacing any organism already there.
+     */
+    void Place(Cell cell, Species type, double _points, double _strength) {
+        Chunk &chunk = ChunkFor(cell);
+        size_t local = LocalIndex(cell);
+        uint64_t &row = chunk.occupied[cell.y & CHUNK_MASK];
+        uint64_t bit = uint64_t(1) << (cell.x & CHUNK_MASK);
+        if (row & bit) {speciesCount[(size_t) chunk.species[local]]--;}
+        else {
+            row |= bit;
+            chunk.count++;
+        }
+        speciesCount[(size_t) type]++;
+        chunk.species[local] = type;
+        chunk.points[local] = _points;
+        chunk.strength[local] = _strength;
+    }
+
+
+    /**
+     * Empties a cell, if it is occupied. The chunk stays allocated until the next update starts.
+     */
+    void Clear(Cell cell) {
+        Chunk* chunk = ChunkOf(cell);
+        if (chunk == nullptr) {return;}
+        uint64_t &row = chunk->occupied[cell.y & CHUNK_MASK];
+        uint64_t bit = uint64_t(1) << (cell.x & CHUNK_MASK);
+        if (row & bit) {
+            row &= ~bit;
+            chunk->count--;
+            speciesCount[(size_t) chunk->species[LocalIndex(cell)]]--;
+        }
+    }
+
+    // a cell's fields, which must be in an allocated chunk
+    Species &SpeciesOf(Cell cell) {return ChunkOf(cell)->species[LocalIndex(cell)];}
+    double &PointsOf(Cell cell) {return ChunkOf(cell)->points[LocalIndex(cell)];}
+    double &StrengthOf(Cell cell) {return ChunkOf(cell)->strength[LocalIndex(cell)];}
+
+
+    /**
+     * Picks a random cell in the 3x3 neighborhood (including the cell itself) on the toroidal grid, with the same
+     * draw as emp::World::GetRandomNeighborPos.
+     */
+    Cell NeighborOf(Cell cell) {
+        const int offset = random.GetInt(9);
+        const int64_t x = (int64_t) cell.x + offset % 3 - 1;
+        const int64_t y = (int64_t) cell.y + offset / 3 - 1;
+        return {(uint32_t) (x < 0 ? width - 1 : (x == width ? 0 : x)),
+                (uint32_t) (y < 0 ? height - 1 : (y == height ? 0 : y))};
+    }
+
+
+    /**
+     * Draws a random cell for seeding, as the other worlds do (which never choose the last cell).
+     */
+    Cell RandomCell() {
+        size_t i = GetSize() - 1 <= UINT32_MAX ? (size_t) random.GetUInt((uint32_t) (GetSize() - 1))
+                                               : (size_t) (random.GetUInt64() % (GetSize() - 1));
+        return {(uint32_t) (i % width), (uint32_t) (i / width)};
+    }
+
+
+    /**
+     * Lists the occupied cells in row-major order, one row of chunks at a time.
+     */
+    void GatherOccupied() {
+        occupiedCells.clear();
+        for (size_t first = 0; first < liveChunks.size();) {
+            size_t cy = liveChunks[first] / chunksX;
+            chunkRow.clear();
+            size_t last = first;
+            while (last < liveChunks.size() && liveChunks[last] / chunksX == cy) {
+                chunkRow.push_back(liveChunks[last] % chunksX);
+                last++;
+            }
+            size_t rows = std::min<size_t>(CHUNK_SIDE, height - cy * CHUNK_SIDE);
+            for (size_t ly = 0; ly < rows; ly++) {
+                uint32_t y = (uint32_t) (cy * CHUNK_SIDE + ly);
+                for (size_t cx : chunkRow) {
+                    for (uint64_t bits = chunks[cy * chunksX + cx]->occupied[ly]; bits; bits &= bits - 1) {
+                        occupiedCells.push_back(Pack({(uint32_t) (cx * CHUNK_SIDE + __builtin_ctzll(bits)), y}));
+                    }
+                }
+            }
+            first = last;
+        }
+    }
+
+
+    // one organism's turn, following CompactWorld's kernels
+
+    Cell MoveOrganism(Cell current) {
+        Species type = SpeciesOf(current);
+        double _points = PointsOf(current);
+        double _strength = StrengthOf(current);
+        Clear(current);
+        Cell target = NeighborOf(current);
+        AE_COUNT(COUNTER_MOVES);
+        if (replayLog) {replayLog->Record(ReplayEventType::Move, type, IndexOf(current), IndexOf(target), _strength);}
+
+        if (Occupied(target)) {
+            // only the mover's side of the interaction matters, since the occupant is displaced either way
+            AE_COUNT(COUNTER_MOVES_ONTO_OCCUPIED);
+#if AE_INSTRUMENT
+            bool isHunt = IsHunt(type, SpeciesOf(target)) || IsHunt(SpeciesOf(target), type);
+            AE_COUNT(isHunt ? COUNTER_ENCOUNTER_HUNTS : COUNTER_ENCOUNTER_FIGHTS);
+#endif
+            EncounterOutcome outcome = Encounter(type, _strength, SpeciesOf(target), StrengthOf(target), params);
+            _strength += outcome.firstGain;
+            if (replayLog) {
+                replayLog->Record(ReplayEventType::Encounter, type, IndexOf(current), IndexOf(target), _strength,
+                                  SpeciesOf(target), outcome.firstSurvives);
+            }
+        }
+        Place(target, type, _points, _strength);
+        return target;
+    }
+
+
+    void ManageHuntingAt(Cell predator) {
+        int numKills = 0;
+        for (size_t i = 0; i < params.huntProbes; i++) { // predator checks random nearby cells and hunts if prey is present
+            Cell neighbor = NeighborOf(predator);
+            AE_COUNT(COUNTER_HUNT_PROBES);
+            if (Occupied(neighbor) && IsHunt(SpeciesOf(predator), SpeciesOf(neighbor))) {
+                EncounterOutcome outcome = Encounter(SpeciesOf(predator), StrengthOf(predator), SpeciesOf(neighbor),
+                                                     StrengthOf(neighbor), params);
+                StrengthOf(predator) += outcome.firstGain;
+                StrengthOf(neighbor) += outcome.secondGain;
+                if (replayLog) {
+                    replayLog->Record(ReplayEventType::Hunt, SpeciesOf(predator), IndexOf(predator), IndexOf(neighbor),
+                                      StrengthOf(outcome.firstSurvives ? predator : neighbor), SpeciesOf(neighbor),
+                                      outcome.firstSurvives);
+                }
+                if (outcome.firstSurvives) { // predator kills and eats the prey
+                    Clear(neighbor);
+                    numKills++;
+                    AE_COUNT(COUNTER_HUNT_KILLS);
+                }
+                else { // prey kills the predator
+                    AE_COUNT(COUNTER_HUNT_DEFEATS);
+                    Clear(predator);
+                    return;
+                }
+            }
+        }
+
+        // if predator hasn't eaten any prey, reduce its strength due to lack of food
+        if (numKills == 0) {
+            AE_COUNT(COUNTER_HUNT_MISSES);
+            StrengthOf(predator) -= params.starvationLoss * StrengthOf(predator);
+            if (replayLog) {
+                replayLog->Record(ReplayEventType::Starve, SpeciesOf(predator), IndexOf(predator), IndexOf(predator),
+                                  StrengthOf(predator));
+            }
+        }
+    }
+
+
+    void ManageDeathAt(Cell cell) {
+        if (Occupied(cell) && StrengthOf(cell) < params.deathThreshold) {
+            AE_COUNT(COUNTER_WEAKNESS_DEATHS);
+            if (replayLog) {
+                replayLog->Record(ReplayEventType::Death, SpeciesOf(cell), IndexOf(cell), IndexOf(cell), StrengthOf(cell));
+            }
+            Clear(cell);
+        }
+    }
+
+
+    void ManageReproductionAt(Cell cell) {
+        if (!Occupied(cell)) {
+            return;
+        }
+        Species type = SpeciesOf(cell);
+        double threshold = params.Of(type).reproductionThreshold;
+        if (PointsOf(cell) >= threshold) {
+            double offspringStrength = StrengthOf(cell) + random.GetRandNormal(0.0, params.Of(type).mutationSigma);
+            PointsOf(cell) -= threshold;
+            Cell birthCell = NeighborOf(cell);
+            AE_COUNT(COUNTER_BIRTHS);
+            if (Occupied(birthCell)) {AE_COUNT(COUNTER_BIRTHS_OVERWRITING);}
+            if (birthCell.x == cell.x && birthCell.y == cell.y) {AE_COUNT(COUNTER_BIRTHS_OVER_PARENT);}
+            if (replayLog) {
+                replayLog->Record(ReplayEventType::Birth, type, IndexOf(cell), IndexOf(birthCell), offspringStrength);
+            }
+            Place(birthCell, type, 0.0, offspringStrength);
+        }
+    }
+
+    public:
+
+    ChunkedWorld(emp::Random &_random) : random(_random) {;}
+    ~ChunkedWorld() {FreeChunks();}
+    ChunkedWorld(const ChunkedWorld &) = delete;
+    ChunkedWorld &operator=(const ChunkedWorld &) = delete;
+
+    size_t GetSize() const {return (size_t) width * height;}
+    size_t GetWidth() const {return width;}
+    size_t GetHeight() const {return height;}
+    size_t GetUpdate() const {return update;}
+    emp::Random &GetRandom() {return random;}
+
+
+    /**
+     * @return The number of chunks allocated to hold organisms.
+     */
+    size_t GetNumChunks() const {return liveChunks.size();}
+
+
+    /**
+     * @return Bytes held for the grid: the chunk table plus every allocated chunk, including spares.
+     */
+    size_t GetMemoryBytes() const {
+        return chunks.size() * sizeof(Chunk*) + (liveChunks.size() + spareChunks.size()) * sizeof(Chunk);
+    }
+
+
+    const EcologyParams &GetParams() const {return params;}
+    void SetParams(const EcologyParams &_params) {params = _params;}
+
+
+    /**
+     * Turns on per-phase timing of Update(), accumulating into the given profile (or turns it off if null).
+     * @param _profile The profile to accumulate into.
+     */
+    void SetProfile(PhaseProfile* _profile) {profile = _profile;}
+
+
+    /**
+     * Has no effect: ChunkedWorld always schedules only the occupied cells, since shuffling every cell of the
+     * grids it is meant for is what it exists to avoid.
+     */
+    void SetOccupiedOnlyScheduling(bool) {;}
+
+
+    /**
+     * Reports every move, interaction, death, and birth to the given log (or stops reporting if null).
+     * @param _replayLog The log to record to or check against.
+     */
+    void SetReplayLog(ReplayLog* _replayLog) {replayLog = _replayLog;}
+
+
+    /**
+     * Counts the organisms of a species currently in the world (kept up to date as organisms come and go).
+     * @param type The species to count.
+     * @return The number of organisms of that species.
+     */
+    size_t CountSpecies(Species type) const {return speciesCount[(size_t) type];}
+
+
+    /**
+     * Places an organism at the given position, replacing any organism already there.
+     * @param i The position in the population.
+     * @param type The organism's species.
+     * @param _points The organism's reproduction points.
+     * @param _strength The organism's strength.
+     */
+    void AddOrgAt(size_t i, Species type, double _points, double _strength) {
+        Place({(uint32_t) (i % width), (uint32_t) (i / width)}, type, _points, _strength);
+    }
+
+
+    /**
+     * Removes the organism at the given position, if there is one.
+     * @param i The position in the population.
+     */
+    void DoDeath(size_t i) {
+        Clear({(uint32_t) (i % width), (uint32_t) (i / width)});
+    }
+
+
+    /**
+     * Sizes the world as an empty toroidal grid of at most 2^32 - 1 cells per side.
+     * @param _width The number of grid cells in each row.
+     * @param _height The number of grid cells in each column.
+     */
+    void Resize(size_t _width, size_t _height) {
+        width = (uint32_t) _width;
+        height = (uint32_t) _height;
+        chunksX = (width + CHUNK_SIDE - 1) / CHUNK_SIDE;
+        chunksY = (height + CHUNK_SIDE - 1) / CHUNK_SIDE;
+        FreeChunks();
+        chunks.assign(chunksX * chunksY, nullptr);
+        std::fill(speciesCount, speciesCount + NUM_SPECIES, 0);
+    }
+
+
+    /**
+     * Sizes the world as a toroidal grid and seeds it with predators and prey at random locations.
+     * @param _width The number of grid cells in each row.
+     * @param _height The number of grid cells in each column.
+     * @param numPredators The number of predators to add.
+     * @param numPrey The number of prey to add.
+     */
+    void Initialize(size_t _width, size_t _height, size_t numPredators, size_t numPrey) {
+        Resize(_width, _height);
+        for (size_t i = 0; i < numPredators; i++) {
+            double newStrength = params.Of(Species::Predator).initialStrength
+                                 + random.GetRandNormal(0.0, params.Of(Species::Predator).mutationSigma);
+            Place(RandomCell(), Species::Predator, 0.0, newStrength);
+        }
+        for (size_t i = 0; i < numPrey; i++) {
+            double newStrength = params.Of(Species::Prey).initialStrength
+                                 + random.GetRandNormal(0.0, params.Of(Species::Prey).mutationSigma);
+            Place(RandomCell(), Species::Prey, 0.0, newStrength);
+        }
+    }
+
+
+    /**
+     * Sizes the world as a toroidal grid and seeds it with the numbers of predators and prey set in its parameters.
+     * @param _width The number of grid cells in each row.
+     * @param _height The number of grid cells in each column.
+     */
+    void Initialize(size_t _width, size_t _height) {
+        Initialize(_width, _height, params.Of(Species::Predator).initialCount, params.Of(Species::Prey).initialCount);
+    }
+
+
+    /**
+     * Updates reproduction points and strength levels for each organism and faciliates movement, hunting, death, and reproduction.
+     */
+    void Update() {
+        AE_TRACE_SCOPE("update");
+        update++;
+        if (replayLog) {replayLog->Record(ReplayEventType::Update, Species::Org, update, 0, 0.0);}
+        ReleaseEmptyChunks();
+        {
+            AE_TRACE_SCOPE("accrual");
+            PhaseTimer timer(profile, PHASE_ACCRUAL);
+            for (size_t id : liveChunks) {
+                Chunk &chunk = *chunks[id];
+                for (size_t ly = 0; ly < CHUNK_SIDE; ly++) {
+                    for (uint64_t bits = chunk.occupied[ly]; bits; bits &= bits - 1) {
+                        chunk.points[ly * CHUNK_SIDE + __builtin_ctzll(bits)] += params.pointsPerUpdate; // as time passes, organism's ability to reproduce increases
+                    }
+                }
+            }
+        }
+
+        // permutation ensures that organisms early in the population don't have an advantage
+        AE_TRACE_SCOPE("turns");
+        GatherOccupied();
+        for (size_t packed : scheduler.Shuffle(random, occupiedCells)) {
+            Cell cell = Unpack(packed);
+            if (!Occupied(cell)) {
+                continue;
+            }
+            if (profile) {profile->organismsProcessed++;}
+
+            // moves organism and executes changes (hunting, death, and reproduction) at its new position
+            bool hunts = SpeciesHunts(SpeciesOf(cell));
+            Cell newCell;
+            {
+                PhaseTimer timer(profile, PHASE_MOVE);
+                newCell = MoveOrganism(cell);
+            }
+            if (hunts) {
+                PhaseTimer timer(profile, PHASE_HUNT);
+                ManageHuntingAt(newCell);
+            }
+            {
+                PhaseTimer timer(profile, PHASE_DEATH);
+                ManageDeathAt(newCell);
+            }
+            {
+                PhaseTimer timer(profile, PHASE_REPRODUCTION);
+                ManageReproductionAt(newCell);
+            }
+        }
+        AE_TRACE_COUNTERS();
+    }
+};
+#endif
@@ -0,0 +1,526 @@
+#ifndef CLUSTERS_H
+#define CLUSTERS_H
+
+#include "emp/base/vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include "NeighborSampler.h"
+#include "Species.h"
+
+
+constexpr size_t CLUSTER_SIZE_BINS = 32; // bin k counts clusters of 2^k to 2^(k+1)-1 cells
+
+
+/**
+ * One species' spatial structure after an update: its clusters (groups of its organisms connected through any of
+ * the 8 neighboring cells) and its front (its organisms next to one of another species).
+ */
+struct ClusterStats {
+    size_t cells = 0;
+    size_t clusters = 0;
+    size_t sizeCounts[CLUSTER_SIZE_BINS] = {};
+    size_t frontCells = 0;
+    double frontX = NAN;  // the front's circular mean position, NaN when it has no front or no defined mean
+    double frontY = NAN;
+    double frontVX = NAN; // how far the mean moved since the previous update, in cells (shortest way round)
+    double frontVY = NAN;
+    double frontRX = 0;   // how concentrated the front is around its mean, from 0 (spread evenly) to 1 (one column)
+    double frontRY = 0;
+};
+
+
+/**
+ * Keeps track of the clusters and fronts of a toroidal grid as organisms are placed and removed, so their
+ * statistics can be reported every update without rescanning the grid.
+ *
+ * Every occupied cell carries its cluster's label. A placement joins the clusters around it, relabeling the cells
+ * of the smaller ones. A removal can split a cluster, but usually can't: if the removed cell's neighbors of the
+ * same species are connected among themselves within its 3x3 neighborhood, every path through it has a way around.
+ * Otherwise the cluster is marked and its removed cell's neighbors kept as seeds, and at the end of the update
+ * searches from the seeds advance in turn until all but one have run out of cells; the finished ones are the
+ * pieces that broke off and get new labels, and the unfinished one keeps the old label without being explored to
+ * the end. The cost of an update is therefore proportional to its events and the pieces that break off, not to the
+ * grid.
+ *
+ * A cell is on its species' front if one of its neighbors holds another species. Each cell's count of such
+ * neighbors is kept up to date, and with it fixed-point sums of the cosine and sine of the front cells' positions
+ * around the torus in each direction, from which the front's circular mean position (and so its velocity) comes.
+ *
+ * Grids must be at least 3 cells on each side.
+ */
+class Clusters {
+    static constexpr uint32_t NO_CLUSTER = UINT32_MAX;
+    static constexpr uint8_t EMPTY = UINT8_MAX;
+    static constexpr double FIXED_ONE = 1 << 20; // scale of the fixed-point trigonometric tables
+
+    struct Cluster {
+        size_t size;
+        Species species;
+        bool mayBeSplit; // lost a cell whose neighbors weren't locally connected this update
+    };
+
+    struct Cell {
+        uint32_t label;  // the occupant's cluster, or NO_CLUSTER
+        uint8_t species; // the occupant's species, or EMPTY
+        uint8_t foreign; // neighbors holding another species, while occupied
+    };
+
+    struct SplitSeed {
+        uint32_t cluster;
+        size_t cell;
+    };
+
+    size_t width = 0;
+    size_t height = 0;
+    NeighborSampler neighbors;        // looks up each cell's ring of 8 neighbors without dividing
+    emp::vector<Cell> grid;           // kept together, so an event's neighborhood is three cache lines
+    emp::vector<Cluster> clusters;
+    emp::vector<uint32_t> freeLabels;    // labels that can be reused
+    emp::vector<uint32_t> retiredLabels; // labels emptied this update, reused after it so seeds stay valid
+    emp::vector<SplitSeed> splitSeeds;
+    ClusterStats stats[NUM_SPECIES];
+
+    // the front's sums of cos and sin of x and y, in units of 1/FIXED_ONE, so adding and removing cells is exact
+    int64_t frontSums[NUM_SPECIES][4] = {};
+    emp::vector<int32_t> cosX, sinX, cosY, sinY;
+
+    // scratch for the split searches: a cell is visited by search k of the current check if mark is markBase + k
+    emp::vector<uint32_t> mark;
+    uint32_t markBase = 1;
+    emp::vector<emp::vector<size_t>> searchQueues;
+    emp::vector<size_t> searchHeads;
+    emp::vector<size_t> searchGroups; // searches that have met are merged, as a small union-find
+    emp::vector<uint8_t> groupActive;
+    emp::vector<size_t> queue;
+
+    FILE* report = nullptr;
+    emp::vector<char> reportBuffer = emp::vector<char>(1 << 16);
+
+
+    /**
+     * Calls a function for each of a cell's 8 neighbors, in NeighborSampler::Ring's order.
+     * @param cell The cell.
+     * @param visit The function to call with each neighbor.
+     */
+    template <typename FUNC>
+    void ForEachNeighbor(size_t cell, FUNC &&visit) const {
+        size_t ring[8];
+        neighbors.Ring(cell, ring);
+        for (size_t n : ring) {
+            visit(n);
+        }
+    }
+
+
+    /**
+     * Counts the groups that the occupied cells around a cell form among themselves.
+     * @param ring One bit per neighbor, in NeighborSampler::Ring's order.
+     * @return The number of groups.
+     */
+    static int RingComponents(unsigned ring) {
+        // neighbors next to each other round the ring touch, and so do two sides with a corner between them
+        for (unsigned corner = 0; corner < 8; corner += 2) {
+            if ((ring >> ((corner + 7) & 7) & 1) && (ring >> (corner + 1) & 1)) {
+                ring |= 1u << corner;
+            }
+        }
+        if (ring == 0xff) {
+            return 1;
+        }
+        int runs = 0;
+        for (unsigned i = 0; i < 8; i++) {
+            runs += (ring >> i & 1) && !(ring >> ((i + 1) & 7) & 1);
+        }
+        return runs;
+    }
+
+
+    static size_t SizeBin(size_t size) {
+        return std::min<size_t>(63 - __builtin_clzll(size), CLUSTER_SIZE_BINS - 1);
+    }
+
+
+    uint32_t NewCluster(Species species) {
+        uint32_t id;
+        if (freeLabels.empty()) {
+            id = (uint32_t) clusters.size();
+            clusters.emplace_back();
+        }
+        else {
+            id = freeLabels.back();
+            freeLabels.pop_back();
+        }
+        clusters[id] = {0, species, false};
+        stats[(size_t) species].clusters++;
+        return id;
+    }
+
+
+    /**
+     * Changes a cluster's size, keeping the size distribution up to date and retiring the cluster once it is empty.
+     * @param id The cluster.
+     * @param size Its new size.
+     */
+    void SetSize(uint32_t id, size_t size) {
+        Cluster &cluster = clusters[id];
+        ClusterStats &speciesStats = stats[(size_t) cluster.species];
+        if (cluster.size) {speciesStats.sizeCounts[SizeBin(cluster.size)]--;}
+        cluster.size = size;
+        if (size) {
+            speciesStats.sizeCounts[SizeBin(size)]++;
+        }
+        else {
+            speciesStats.clusters--;
+            retiredLabels.push_back(id);
+        }
+    }
+
+
+    /**
+     * Gives the connected cells of one cluster around a cell another label.
+     * @param start The cell.
+     * @param from The cluster's label.
+     * @param to The new label.
+     * @return The number of cells relabeled.
+     */
+    size_t Relabel(size_t start, uint32_t from, uint32_t to) {
+        queue.clear();
+        queue.push_back(start);
+        grid[start].label = to;
+        for (size_t k = 0; k < queue.size(); k++) {
+            ForEachNeighbor(queue[k], [&](size_t n) {
+                if (grid[n].label == from) {
+                    grid[n].label = to;
+                    queue.push_back(n);
+                }
+            });
+        }
+        return queue.size();
+    }
+
+
+    void UpdateFront(size_t cell, int direction) {
+        size_t x = cell % width;
+        size_t y = cell / width;
+        size_t s = grid[cell].species;
+        frontSums[s][0] += direction * cosX[x];
+        frontSums[s][1] += direction * sinX[x];
+        frontSums[s][2] += direction * cosY[y];
+        frontSums[s][3] += direction * sinY[y];
+        stats[s].frontCells += direction;
+    }
+
+
+    size_t FindGroup(size_t search) {
+        while (searchGroups[search] != search) {
+            searchGroups[search] = searchGroups[searchGroups[search]];
+            search = searchGroups[search];
+        }
+        return search;
+    }
+
+
+    /**
+     * Finds the pieces a cluster marked as possibly split has broken into, starting from its seeds, and gives each
+     * piece but one a new label.
+     * @param id The cluster.
+     * @param seeds Its seeds.
+     * @param numSeeds The number of seeds.
+     */
+    void SplitCluster(uint32_t id, const SplitSeed* seeds, size_t numSeeds) {
+        if (markBase > std::numeric_limits<uint32_t>::max() - numSeeds - 1) {
+            std::fill(mark.begin(), mark.end(), 0);
+            markBase = 1;
+        }
+        auto visitedBy = [&](size_t cell) { return mark[cell] - markBase; }; // >= the number of searches if unvisited
+
+        size_t numSearches = 0;
+        for (size_t k = 0; k < numSeeds; k++) {
+            size_t cell = seeds[k].cell;
+            if (grid[cell].label != id || visitedBy(cell) < numSearches) {
+                continue;
+            }
+            if (searchQueues.size() <= numSearches) {
+                searchQueues.emplace_back();
+                searchHeads.push_back(0);
+                searchGroups.push_back(0);
+            }
+            searchQueues[numSearches].assign(1, cell);
+            searchHeads[numSearches] = 0;
+            searchGroups[numSearches] = numSearches;
+            mark[cell] = markBase + (uint32_t) numSearches;
+            numSearches++;
+        }
+
+        // advance every search one cell at a time; a group of searches (those that have met) that runs out of
+        // cells while another group still has some is a piece on its own
+        while (true) {
+            for (size_t k = 0; k < numSearches; k++) {
+                if (searchHeads[k] == searchQueues[k].size()) {
+                    continue;
+                }
+                size_t cell = searchQueues[k][searchHeads[k]++];
+                ForEachNeighbor(cell, [&](size_t n) {
+                    if (grid[n].label != id) {
+                        return;
+                    }
+                    size_t other = visitedBy(n);
+                    if (other >= numSearches) {
+                        mark[n] = markBase + (uint32_t) k;
+                        searchQueues[k].push_back(n);
+                    }
+                    else {
+                        searchGroups[FindGroup(other)] = FindGroup(k);
+                    }
+                });
+            }
+
+            groupActive.assign(numSearches, 0);
+            for (size_t k = 0; k < numSearches; k++) {
+                if (searchHeads[k] < searchQueues[k].size()) {groupActive[FindGroup(k)] = 1;}
+            }
+            size_t numActive = std::count(groupActive.begin(), groupActive.end(), 1);
+            bool keptOne = numActive > 0; // if every group finished at once, the first keeps the label
+            for (size_t k = 0; k < numSearches; k++) {
+                if (FindGroup(k) != k || groupActive[k] || grid[searchQueues[k][0]].label != id) {
+                    continue; // still searching, or already relabeled
+                }
+                if (!keptOne) {
+                    keptOne = true;
+                    continue;
+                }
+                uint32_t piece = NewCluster(clusters[id].species);
+                size_t moved = Relabel(searchQueues[k][0], id, piece);
+                SetSize(piece, moved);
+                SetSize(id, clusters[id].size - moved);
+            }
+            if (numActive <= 1) {
+                break;
+            }
+        }
+        markBase += (uint32_t) numSearches;
+    }
+
+    public:
+
+        ~Clusters() {
+            if (report) {std::fclose(report);}
+        }
+
+
+        /**
+         * Sizes the tracker for an empty grid, forgetting everything in it.
+         * @param _width The number of grid cells in each row.
+         * @param _height The number of grid cells in each column.
+         */
+        void Resize(size_t _width, size_t _height) {
+            width = _width;
+            height = _height;
+            neighbors.Resize(width, height);
+            grid.assign(width * height, {NO_CLUSTER, EMPTY, 0});
+            mark.assign(width * height, 0);
+            markBase = 1;
+            clusters.clear();
+            freeLabels.clear();
+            retiredLabels.clear();
+            splitSeeds.clear();
+            for (size_t s = 0; s < NUM_SPECIES; s++) {
+                stats[s] = ClusterStats();
+                std::fill(frontSums[s], frontSums[s] + 4, 0);
+            }
+            auto makeTable = [](emp::vector<int32_t> &table, size_t length, double (*trig)(double)) {
+                table.resize(length);
+                for (size_t i = 0; i < length; i++) {
+                    table[i] = (int32_t) std::lround(FIXED_ONE * trig(2 * M_PI * i / length));
+                }
+            };
+            makeTable(cosX, width, std::cos);
+            makeTable(sinX, width, std::sin);
+            makeTable(cosY, height, std::cos);
+            makeTable(sinY, height, std::sin);
+        }
+
+
+        /**
+         * Records an organism placed in an empty cell.
+         * @param cell The cell's position.
+         * @param species The organism's species.
+         */
+        void Place(size_t cell, Species species) {
+            uint8_t s = (uint8_t) species;
+            uint8_t numForeign = 0;
+            uint32_t target = NO_CLUSTER;
+            bool joins = false; // touches more than one cluster
+            size_t ring[8];
+            neighbors.Ring(cell, ring);
+            for (size_t n : ring) {
+                if (grid[n].species == EMPTY) {
+                    continue;
+                }
+                if (grid[n].species != s) {
+                    numForeign++;
+                    if (grid[n].foreign++ == 0) {UpdateFront(n, 1);}
+                }
+                else if (target == NO_CLUSTER) {
+                    target = grid[n].label;
+                }
+                else if (grid[n].label != target) {
+                    joins = true;
+                    if (clusters[grid[n].label].size > clusters[target].size) {target = grid[n].label;}
+                }
+            }
+            grid[cell].species = s;
+            grid[cell].foreign = numForeign;
+            if (numForeign) {UpdateFront(cell, 1);}
+            stats[s].cells++;
+
+            // join the largest neighboring cluster, and bring the others into it
+            if (target == NO_CLUSTER) {
+                target = NewCluster(species);
+            }
+            grid[cell].label = target;
+            SetSize(target, clusters[target].size + 1);
+            for (size_t n : ring) {
+                uint32_t other = grid[n].label;
+                if (!joins || other == NO_CLUSTER || other == target || grid[n].species != s) {
+                    continue;
+                }
+                size_t moved = Relabel(n, other, target);
+                SetSize(other, clusters[other].size - moved);
+                SetSize(target, clusters[target].size + moved);
+            }
+        }
+
+
+        /**
+         * Records an organism leaving a cell (dying, or moving elsewhere). Empty cells are ignored.
+         * @param cell The cell's position.
+         */
+        void Remove(size_t cell) {
+            uint8_t s = grid[cell].species;
+            if (s == EMPTY) {
+                return;
+            }
+            size_t ring[8];
+            neighbors.Ring(cell, ring);
+            unsigned sameSpecies = 0; // one bit per neighbor
+            for (unsigned k = 0; k < 8; k++) {
+                size_t n = ring[k];
+                if (grid[n].species == s) {
+                    sameSpecies |= 1u << k;
+                }
+                else if (grid[n].species != EMPTY && --grid[n].foreign == 0) {
+                    UpdateFront(n, -1);
+                }
+            }
+            if (grid[cell].foreign) {UpdateFront(cell, -1);}
+            grid[cell].foreign = 0;
+            grid[cell].species = EMPTY;
+            stats[s].cells--;
+
+            uint32_t id = grid[cell].label;
+            grid[cell].label = NO_CLUSTER;
+            SetSize(id, clusters[id].size - 1);
+            if (clusters[id].size == 0 || (!clusters[id].mayBeSplit && RingComponents(sameSpecies) <= 1)) {
+                return;
+            }
+            // every piece a marked cluster may have broken into keeps a seed, so later removals add theirs too
+            clusters[id].mayBeSplit = true;
+            for (size_t n : ring) {
+                if (grid[n].label == id) {splitSeeds.push_back({id, n});}
+            }
+        }
+
+
+        /**
+         * Settles the update's possible splits, works out each front's position and velocity, and writes the
+         * report row if a report is open.
+         * @param update The update that has just finished.
+         */
+        void EndUpdate(size_t update) {
+            std::stable_sort(splitSeeds.begin(), splitSeeds.end(),
+                             [](const SplitSeed &a, const SplitSeed &b) { return a.cluster < b.cluster; });
+            for (size_t first = 0, last; first < splitSeeds.size(); first = last) {
+                uint32_t id = splitSeeds[first].cluster;
+                for (last = first; last < splitSeeds.size() && splitSeeds[last].cluster == id; last++) {;}
+                if (clusters[id].size && clusters[id].mayBeSplit) {
+                    SplitCluster(id, &splitSeeds[first], last - first);
+                    clusters[id].mayBeSplit = false;
+                }
+            }
+            splitSeeds.clear();
+            freeLabels.insert(freeLabels.end(), retiredLabels.begin(), retiredLabels.end());
+            retiredLabels.clear();
+
+            for (size_t s = 0; s < NUM_SPECIES; s++) {
+                ClusterStats &speciesStats = stats[s];
+                double lastX = speciesStats.frontX;
+                double lastY = speciesStats.frontY;
+                auto circularMean = [](int64_t cosSum, int64_t sinSum, size_t length) {
+                    if (cosSum == 0 && sinSum == 0) {return (double) NAN;}
+                    double position = std::atan2((double) sinSum, (double) cosSum) / (2 * M_PI) * length;
+                    return position < 0 ? position + length : position;
+                };
+                auto shortestStep = [](double from, double to, size_t length) {
+                    double step = to - from;
+                    return step - length * std::round(step / length);
+                };
+                speciesStats.frontX = circularMean(frontSums[s][0], frontSums[s][1], width);
+                speciesStats.frontY = circularMean(frontSums[s][2], frontSums[s][3], height);
+                speciesStats.frontVX = shortestStep(lastX, speciesStats.frontX, width);
+                speciesStats.frontVY = shortestStep(lastY, speciesStats.frontY, height);
+                double scale = speciesStats.frontCells ? FIXED_ONE * speciesStats.frontCells : 1;
+                speciesStats.frontRX = std::hypot((double) frontSums[s][0], (double) frontSums[s][1]) / scale;
+                speciesStats.frontRY = std::hypot((double) frontSums[s][2], (double) frontSums[s][3]) / scale;
+            }
+
+            if (report) {
+                for (size_t s = 0; s < NUM_SPECIES; s++) {
+                    const ClusterStats &speciesStats = stats[s];
+                    if (s == (size_t) Species::Org) {continue;}
+                    std::fprintf(report, "%zu,%s,%zu,%zu,%zu,%.6g,%.6g,%.6g,%.6g,%.4f,%.4f,", update,
+                                 SpeciesName((Species) s), speciesStats.cells, speciesStats.clusters,
+                                 speciesStats.frontCells, speciesStats.frontX, speciesStats.frontY,
+                                 speciesStats.frontVX, speciesStats.frontVY, speciesStats.frontRX,
+                                 speciesStats.frontRY);
+                    size_t numBins = CLUSTER_SIZE_BINS;
+                    while (numBins > 1 && speciesStats.sizeCounts[numBins - 1] == 0) {numBins--;}
+                    for (size_t bin = 0; bin < numBins; bin++) {
+                        std::fprintf(report, bin ? " %zu" : "%zu", speciesStats.sizeCounts[bin]);
+                    }
+                    std::fputc('\n', report);
+                }
+            }
+        }
+
+
+        /**
+         * @param species The species.
+         * @return The species' clusters and front as of the last EndUpdate (counts are always current).
+         */
+        const ClusterStats &GetStats(Species species) const {return stats[(size_t) species];}
+
+
+        /**
+         * Starts writing a CSV row per species at each EndUpdate: the update, species, organisms, clusters, front
+         * cells, the front's mean position, velocity, and concentration, and the number of clusters in each size bin
+         * (1, 2-3, 4-7, and so on) separated by spaces.
+         * @param path Where to write the report.
+         * @return true if the file was opened.
+         */
+        bool OpenReport(const std::string &path) {
+            report = std::fopen(path.c_str(), "w");
+            if (report == nullptr) {
+                return false;
+            }
+            std::setvbuf(report, reportBuffer.data(), _IOFBF, reportBuffer.size());
+            std::fprintf(report, "update,species,organisms,clusters,front_cells,front_x,front_y,front_vx,front_vy,"
+                                 "front_rx,front_ry,cluster_sizes_log2\n");
+            return true;
+        }
+};
+#endif
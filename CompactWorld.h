@@ -0,0 +1,1048 @@
+#ifndef COMPACT_WORLD_H
+#define COMPACT_WORLD_H
+
+#include "emp/base/vector.hpp"
+#include "emp/math/Random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "Instrument.h"
+#include "NeighborSampler.h"
+#include "Org.h"
+#include "Params.h"
+#include "Profile.h"
+#include "ReplayLog.h"
+#include "Scheduler.h"
+#include "SimdSweeps.h"
+#include "SpeciesKernels.h"
+#include "ThreadPool.h"
+
+
+/**
+ * An alternative storage mode for OrgWorld that keeps each cell's species, points, and strength in contiguous
+ * per-cell arrays with an occupancy bitmap, instead of a vector of pointers to separately allocated Organisms.
+ * It applies the same ecological rules as OrgWorld and draws from the shared generator in the same order, so
+ * both worlds follow the same trajectory for a given seed.
+ *
+ * Given a ThreadPool, Update() instead runs the tiled parallel schedule described at UpdateParallel(), and with
+ * SetSynchronousUpdate() it runs the synchronous step described at UpdateSynchronous().
+ */
+class CompactWorld {
+    emp::Random &random;
+    size_t width = 0;
+    size_t height = 0;
+    size_t update = 0;
+
+    emp::vector<uint64_t> occupied; // one bit per cell
+    emp::vector<Species> species;
+    emp::vector<double> points;
+    emp::vector<double> strength;
+    size_t speciesCount[NUM_SPECIES] = {}; // organisms of each species; see RecountSpecies for when it is current
+
+    EcologyParams params; // the model's ecological constants
+    PhaseProfile* profile = nullptr; // optional per-phase timing, off unless SetProfile is called
+    ThreadPool* threadPool = nullptr; // runs the tiled parallel update when set
+    Scheduler scheduler; // reusable schedule buffer for the serial update
+    bool occupiedOnly = false; // serial update schedules only occupied cells
+    emp::vector<size_t> occupiedCells; // scratch list of occupied cells for occupied-only scheduling
+    emp::vector<emp::vector<size_t>> tileSchedules; // scratch schedule per worker thread
+    bool fastNeighbors = false; // draw neighbors from NeighborSampler instead of the shared generator
+    NeighborSampler sampler;    // wraparound tables for the current grid
+    NeighborStream stream;      // neighbor choices for the serial update, rekeyed every update
+    ReplayLog* replayLog = nullptr; // records or checks every event of the serial update when set
+
+    // state of the synchronous update, allocated on its first use
+    bool synchronous = false;         // Update() runs UpdateSynchronous()
+    uint64_t syncKey = 0;             // keys the update's counter-based draws
+    size_t syncDrawsPerCell = 0;      // draws reserved for each cell per update
+    emp::vector<uint64_t> nextOccupied; // next-state buffers, swapped with the current state after moving
+    emp::vector<Species> nextSpecies;
+    emp::vector<double> nextPoints;
+    emp::vector<double> nextStrength;
+    emp::vector<uint64_t> arrival;    // for each claimed cell, when its current holder arrived
+    emp::vector<uint64_t> hungry;     // predators that have eaten nothing yet this update, one bit per cell
+    emp::vector<uint32_t> hunter;     // for each cell, the predator that will hunt its prey, or NO_HUNTER
+    emp::vector<size_t> huntedCells;  // cells with an entry in hunter
+    emp::vector<EncounterOutcome> huntOutcomes;
+
+    struct SyncBirth {
+        size_t cell;
+        uint64_t arrival;
+        Species type;
+        double strength;
+    };
+    emp::vector<SyncBirth> births;
+
+    static constexpr uint32_t NO_HUNTER = UINT32_MAX;
+
+    // parallel tiles aim for this side length, and are never narrower than the 2-cell reach of one
+    // organism's turn (a move, then a hunt or birth next to the new position) on both sides
+    static constexpr size_t TARGET_TILE_SIDE = 64;
+    static constexpr size_t MIN_TILE_SIDE = 4;
+
+
+    /**
+     * Draws a strength mutation from the shared generator, as Organism::mutate does.
+     * @param type The species being mutated.
+     * @return The amount to add to strength.
+     */
+    double DrawMutation(Species type) {
+        return random.GetRandNormal(0.0, params.Of(type).mutationSigma);
+    }
+
+
+    /**
+     * Marks a cell occupied. Concurrent callers may share a bitmap word, so they update it atomically.
+     * @param i The position in the population.
+     */
+    template <bool CONCURRENT>
+    void SetOccupied(size_t i) {
+        uint64_t bit = uint64_t(1) << (i & 63);
+        if (CONCURRENT) {__atomic_fetch_or(&occupied[i >> 6], bit, __ATOMIC_RELAXED);}
+        else {occupied[i >> 6] |= bit;}
+    }
+
+
+    /**
+     * Marks a cell empty. Concurrent callers may share a bitmap word, so they update it atomically; serial callers
+     * also keep the species counts.
+     * @param i The position in the population.
+     */
+    template <bool CONCURRENT>
+    void ClearOccupied(size_t i) {
+        uint64_t mask = ~(uint64_t(1) << (i & 63));
+        if (CONCURRENT) {__atomic_fetch_and(&occupied[i >> 6], mask, __ATOMIC_RELAXED);}
+        else {
+            if (TestOccupied<false>(i)) {speciesCount[(size_t) species[i]]--;}
+            occupied[i >> 6] &= mask;
+        }
+    }
+
+
+    /**
+     * Checks whether a cell is occupied, reading its bitmap word atomically if other threads may be writing it.
+     * @param i The position in the population.
+     */
+    template <bool CONCURRENT>
+    bool TestOccupied(size_t i) const {
+        uint64_t word = CONCURRENT ? __atomic_load_n(&occupied[i >> 6], __ATOMIC_RELAXED) : occupied[i >> 6];
+        return (word >> (i & 63)) & 1;
+    }
+
+
+    /**
+     * Places an organism at the given position, replacing any organism already there. Serial callers also keep
+     * the species counts.
+     */
+    template <bool CONCURRENT>
+    void Place(size_t i, Species type, double _points, double _strength) {
+        if (!CONCURRENT) {
+            if (TestOccupied<false>(i)) {speciesCount[(size_t) species[i]]--;}
+            speciesCount[(size_t) type]++;
+        }
+        SetOccupied<CONCURRENT>(i);
+        species[i] = type;
+        points[i] = _points;
+        strength[i] = _strength;
+    }
+
+
+    /**
+     * Picks a random position in the 3x3 neighborhood (including the position itself) on the toroidal grid.
+     * @param i The position in the population.
+     * @param rng The generator to draw from.
+     * @return The neighboring position.
+     */
+    size_t NeighborOf(size_t i, emp::Random &rng) const {
+        const int offset = rng.GetInt(9);
+        const int x = (int) (i % width) + offset % 3 - 1;
+        const int y = (int) (i / width) + offset / 3 - 1;
+        const size_t wrappedX = x < 0 ? width - 1 : (x == (int) width ? 0 : x);
+        const size_t wrappedY = y < 0 ? height - 1 : (y == (int) height ? 0 : y);
+        return wrappedX + wrappedY * width;
+    }
+
+
+    /**
+     * Neighbor source that draws each neighbor from an emp::Random when it is needed, as emp::World does, which
+     * keeps the serial update in step with OrgWorld.
+     */
+    struct GeneratorNeighbors {
+        const CompactWorld &world;
+        emp::Random &rng;
+        size_t probeFrom = 0;
+
+        size_t operator()(size_t i) {return world.NeighborOf(i, rng);}
+        void BeginProbes(size_t i) {probeFrom = i;}
+        size_t Probe(size_t) {return world.NeighborOf(probeFrom, rng);}
+    };
+
+
+    /**
+     * Neighbor source that draws from a NeighborStream through the precomputed tables, taking hunting probes
+     * four at a time.
+     */
+    struct SampledNeighbors {
+        const NeighborSampler &sampler;
+        NeighborStream &stream;
+        size_t probeFrom = 0;
+        size_t probes[4] = {};
+
+        size_t operator()(size_t i) {return sampler.Neighbor(i, stream);}
+        void BeginProbes(size_t i) {probeFrom = i;}
+        size_t Probe(size_t k) {
+            if (k % 4 == 0) {sampler.Sample4(probeFrom, stream, probes);}
+            return probes[k % 4];
+        }
+    };
+
+
+    /**
+     * Calls fn with the serial update's neighbor source.
+     */
+    template <typename FN>
+    void WithNeighbors(FN fn) {
+        if (fastNeighbors) {
+            SampledNeighbors neighbors{sampler, stream};
+            fn(neighbors);
+        }
+        else {
+            GeneratorNeighbors neighbors{*this, random};
+            fn(neighbors);
+        }
+    }
+
+
+    // the kernels below implement one organism's turn; CONCURRENT is set when other tiles run at the same time,
+    // and NEIGHBORS is the source of random neighbors (GeneratorNeighbors or SampledNeighbors). Only the serial
+    // update reports to the replay log, since concurrent tiles have no single order of events.
+
+    template <bool CONCURRENT, typename NEIGHBORS>
+    size_t MoveKernel(size_t currentIndex, NEIGHBORS &neighbors) {
+        ClearOccupied<CONCURRENT>(currentIndex);
+        size_t indexToMove = neighbors(currentIndex);
+        AE_COUNT(COUNTER_MOVES);
+        if (!CONCURRENT && replayLog) {
+            replayLog->Record(ReplayEventType::Move, species[currentIndex], currentIndex, indexToMove,
+                              strength[currentIndex]);
+        }
+
+        if (TestOccupied<CONCURRENT>(indexToMove)) {
+            AE_COUNT(COUNTER_MOVES_ONTO_OCCUPIED);
+#if AE_INSTRUMENT
+            bool isHunt = IsHunt(species[currentIndex], species[indexToMove]) || IsHunt(species[indexToMove], species[currentIndex]);
+            AE_COUNT(isHunt ? COUNTER_ENCOUNTER_HUNTS : COUNTER_ENCOUNTER_FIGHTS);
+#endif
+            // only the mover's side of the interaction matters, since the occupant is displaced either way
+            EncounterOutcome outcome = Encounter(species[currentIndex], strength[currentIndex], species[indexToMove],
+                                                 strength[indexToMove], params);
+            strength[currentIndex] += outcome.firstGain;
+            if (!CONCURRENT && replayLog) {
+                replayLog->Record(ReplayEventType::Encounter, species[currentIndex], currentIndex, indexToMove,
+                                  strength[currentIndex], species[indexToMove], outcome.firstSurvives);
+            }
+        }
+
+        Place<CONCURRENT>(indexToMove, species[currentIndex], points[currentIndex], strength[currentIndex]);
+        return indexToMove;
+    }
+
+
+    template <bool CONCURRENT, typename NEIGHBORS>
+    void HuntKernel(size_t predatorPosition, NEIGHBORS &neighbors) {
+        int numKills = 0;
+        neighbors.BeginProbes(predatorPosition);
+        for (size_t i = 0; i < params.huntProbes; i++) { // predator checks random nearby locations and hunts if prey is present
+            size_t randomIndex = neighbors.Probe(i);
+            AE_COUNT(COUNTER_HUNT_PROBES);
+            if (TestOccupied<CONCURRENT>(randomIndex) && IsHunt(species[predatorPosition], species[randomIndex])) {
+                EncounterOutcome outcome = Encounter(species[predatorPosition], strength[predatorPosition],
+                                                     species[randomIndex], strength[randomIndex], params);
+                strength[predatorPosition] += outcome.firstGain;
+                strength[randomIndex] += outcome.secondGain;
+                if (!CONCURRENT && replayLog) {
+                    replayLog->Record(ReplayEventType::Hunt, species[predatorPosition], predatorPosition, randomIndex,
+                                      strength[outcome.firstSurvives ? predatorPosition : randomIndex],
+                                      species[randomIndex], outcome.firstSurvives);
+                }
+                if (outcome.firstSurvives) { // predator kills and eats the prey
+                    ClearOccupied<CONCURRENT>(randomIndex);
+                    numKills++;
+                    AE_COUNT(COUNTER_HUNT_KILLS);
+                }
+                else { // prey kills the predator
+                    AE_COUNT(COUNTER_HUNT_DEFEATS);
+                    ClearOccupied<CONCURRENT>(predatorPosition);
+                    return;
+                }
+            }
+        }
+
+        // if predator hasn't eaten any prey, reduce its strength due to lack of food
+        if (numKills == 0) {
+            AE_COUNT(COUNTER_HUNT_MISSES);
+            strength[predatorPosition] -= params.starvationLoss * strength[predatorPosition];
+            if (!CONCURRENT && replayLog) {
+                replayLog->Record(ReplayEventType::Starve, species[predatorPosition], predatorPosition,
+                                  predatorPosition, strength[predatorPosition]);
+            }
+        }
+    }
+
+
+    template <bool CONCURRENT>
+    void DeathKernel(size_t currentIndex) {
+        if (TestOccupied<CONCURRENT>(currentIndex) && strength[currentIndex] < params.deathThreshold) {
+            AE_COUNT(COUNTER_WEAKNESS_DEATHS);
+            if (!CONCURRENT && replayLog) {
+                replayLog->Record(ReplayEventType::Death, species[currentIndex], currentIndex, currentIndex,
+                                  strength[currentIndex]);
+            }
+            ClearOccupied<CONCURRENT>(currentIndex);
+        }
+    }
+
+
+    template <bool CONCURRENT, typename NEIGHBORS>
+    void ReproductionKernel(size_t currentIndex, emp::Random &rng, NEIGHBORS &neighbors) {
+        if (!TestOccupied<CONCURRENT>(currentIndex)) {
+            return;
+        }
+        Species type = species[currentIndex];
+        double threshold = params.Of(type).reproductionThreshold;
+        if (points[currentIndex] >= threshold) {
+            double offspringStrength = strength[currentIndex] + rng.GetRandNormal(0.0, params.Of(type).mutationSigma);
+            points[currentIndex] -= threshold;
+            size_t birthIndex = neighbors(currentIndex);
+            AE_COUNT(COUNTER_BIRTHS);
+            if (TestOccupied<CONCURRENT>(birthIndex)) {AE_COUNT(COUNTER_BIRTHS_OVERWRITING);}
+            if (birthIndex == currentIndex) {AE_COUNT(COUNTER_BIRTHS_OVER_PARENT);}
+            if (!CONCURRENT && replayLog) {
+                replayLog->Record(ReplayEventType::Birth, type, currentIndex, birthIndex, offspringStrength);
+            }
+            Place<CONCURRENT>(birthIndex, type, 0.0, offspringStrength);
+        }
+    }
+
+
+    /**
+     * Adds the occupants of a range of bitmap words to per-species counts.
+     * @param firstWord The first word of the range.
+     * @param endWord One past the last word of the range.
+     * @param counts The counts to add to.
+     */
+    void TallySpecies(size_t firstWord, size_t endWord, size_t (&counts)[NUM_SPECIES]) const {
+        for (size_t word = firstWord; word < endWord; word++) {
+            for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                counts[(size_t) species[word * 64 + __builtin_ctzll(bits)]]++;
+            }
+        }
+    }
+
+
+    /**
+     * Recomputes the species counts from the occupancy bitmap. The serial update keeps the counts as organisms are
+     * placed and cleared, but the parallel and synchronous updates (whose tiles or sweeps change the bitmap without
+     * the counts) and Restore recount once they finish.
+     */
+    void RecountSpecies() {
+        std::fill(speciesCount, speciesCount + NUM_SPECIES, 0);
+        TallySpecies(0, occupied.size(), speciesCount);
+    }
+
+
+    /**
+     * Gets the number of tiles to split one side of the grid into for the parallel update. The count is even so
+     * that tiles of the same checkerboard color never touch, even across the torus seam.
+     * @param side The side length of the grid.
+     * @return The number of tiles, or 0 if the side is too short to tile.
+     */
+    static size_t TilesAlong(size_t side) {
+        size_t tiles = 2 * std::max<size_t>(1, side / (2 * TARGET_TILE_SIDE));
+        return side / tiles >= MIN_TILE_SIDE ? tiles : 0;
+    }
+
+
+    /**
+     * Runs every occupied cell of one tile through a turn, in a random order drawn from the tile's own generator.
+     * @param x0 First column of the tile.
+     * @param x1 One past the last column of the tile.
+     * @param y0 First row of the tile.
+     * @param y1 One past the last row of the tile.
+     * @param seed Seed for the tile's generator.
+     * @param schedule Scratch space for the tile's schedule.
+     * @return The number of organisms that took a turn.
+     */
+    size_t UpdateTile(size_t x0, size_t x1, size_t y0, size_t y1, int seed, emp::vector<size_t> &schedule) {
+        AE_TRACE_SCOPE("tile");
+        emp::Random rng{seed};
+        size_t tileWidth = x1 - x0;
+        size_t numCells = tileWidth * (y1 - y0);
+
+        // inside-out shuffle of the tile's cells, as emp::GetPermutation does for the whole grid
+        schedule.resize(numCells);
+        for (size_t k = 0; k < numCells; k++) {
+            size_t j = k ? rng.GetUInt(k+1) : 0;
+            schedule[k] = schedule[j];
+            schedule[j] = (y0 + k / tileWidth) * width + x0 + k % tileWidth;
+        }
+
+        if (fastNeighbors) {
+            NeighborStream tileStream{Mix((uint64_t) seed)};
+            SampledNeighbors neighbors{sampler, tileStream};
+            return TileTurns(schedule, rng, neighbors);
+        }
+        GeneratorNeighbors neighbors{*this, rng};
+        return TileTurns(schedule, rng, neighbors);
+    }
+
+
+    /**
+     * Gives each occupied cell of a tile's schedule its turn.
+     * @return The number of organisms that took a turn.
+     */
+    template <typename NEIGHBORS>
+    size_t TileTurns(const emp::vector<size_t> &schedule, emp::Random &rng, NEIGHBORS &neighbors) {
+        size_t turns = 0;
+        for (size_t i : schedule) {
+            if (!TestOccupied<true>(i)) {
+                continue;
+            }
+            turns++;
+            bool hunts = SpeciesHunts(species[i]);
+            size_t newIndex = MoveKernel<true>(i, neighbors);
+            if (hunts) {HuntKernel<true>(newIndex, neighbors);}
+            DeathKernel<true>(newIndex);
+            ReproductionKernel<true>(newIndex, rng, neighbors);
+        }
+        return turns;
+    }
+
+
+    /**
+     * Mixes a 64-bit value (splitmix64 finalizer), used to derive independent tile seeds.
+     * @param value The value to mix.
+     * @return The mixed value.
+     */
+    static uint64_t Mix(uint64_t value) {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+
+    // the synchronous update's draws are made per cell from a counter-based generator keyed once per update, so
+    // they don't depend on the order cells are visited in: draws 0 and 1 pick where the organism moves and when it
+    // arrives, draws 2..huntProbes+1 its hunting probes, and the next four where its offspring goes, the
+    // offspring's mutation, and when it arrives
+
+    uint64_t SyncDraw(size_t i, size_t draw) const {
+        return CounterRandom::Hash(syncKey, i * syncDrawsPerCell + draw);
+    }
+
+    size_t SyncNeighbor(size_t i, size_t draw) const {
+        return sampler.Neighbor(i, (unsigned) (((SyncDraw(i, draw) & 0xffffffffULL) * 9) >> 32));
+    }
+
+    /**
+     * @return A standard normal value from two of a cell's draws (Box-Muller).
+     */
+    double SyncNormal(size_t i, size_t draw) const {
+        double u1 = ((SyncDraw(i, draw) >> 11) + 1) * 0x1.0p-53; // in (0, 1], so its log is finite
+        double u2 = (SyncDraw(i, draw + 1) >> 11) * 0x1.0p-53;
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+
+    /**
+     * Synchronous movement: every organism picks a neighboring cell (possibly its own) to move to in the next-state
+     * buffers, and a random time to arrive there. As in the asynchronous update, where a mover meeting an occupant
+     * gains or loses strength from the encounter but always displaces it, the organism arriving last takes a
+     * contested cell: each claimant is checked against the cell's holder so far, and the later of the two gains
+     * from their encounter and holds the cell. The buffers then become the current state.
+     */
+    void SyncMoves() {
+        nextOccupied.assign(occupied.size(), 0);
+        for (size_t word = 0; word < occupied.size(); word++) {
+            for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                size_t i = word * 64 + __builtin_ctzll(bits);
+                size_t target = SyncNeighbor(i, 0);
+                uint64_t arrives = SyncDraw(i, 1);
+                uint64_t targetBit = uint64_t(1) << (target & 63);
+                AE_COUNT(COUNTER_MOVES);
+                if (!(nextOccupied[target >> 6] & targetBit)) {
+                    nextOccupied[target >> 6] |= targetBit;
+                    nextSpecies[target] = species[i];
+                    nextPoints[target] = points[i];
+                    nextStrength[target] = strength[i];
+                    arrival[target] = arrives;
+                    continue;
+                }
+                AE_COUNT(COUNTER_MOVES_ONTO_OCCUPIED);
+#if AE_INSTRUMENT
+                bool isHunt = IsHunt(nextSpecies[target], species[i]) || IsHunt(species[i], nextSpecies[target]);
+                AE_COUNT(isHunt ? COUNTER_ENCOUNTER_HUNTS : COUNTER_ENCOUNTER_FIGHTS);
+#endif
+                if (arrives <= arrival[target]) { // the holder arrives later, meets this organism, and displaces it
+                    nextStrength[target] += Encounter(nextSpecies[target], nextStrength[target], species[i],
+                                                      strength[i], params).firstGain;
+                }
+                else {
+                    double gain = Encounter(species[i], strength[i], nextSpecies[target], nextStrength[target],
+                                            params).firstGain;
+                    nextSpecies[target] = species[i];
+                    nextPoints[target] = points[i];
+                    nextStrength[target] = strength[i] + gain;
+                    arrival[target] = arrives;
+                }
+            }
+        }
+        std::swap(occupied, nextOccupied);
+        std::swap(species, nextSpecies);
+        std::swap(points, nextPoints);
+        std::swap(strength, nextStrength);
+    }
+
+
+    /**
+     * Synchronous hunting: every predator probes its neighbors, and each prey probed by at least one predator is
+     * hunted by the strongest of them (the first in position order on a tie). All hunts are resolved against the
+     * strengths from before any of them and then applied together; a predator killed in one hunt still eats the
+     * prey it won elsewhere. Predators left alive that ate nothing starve in one masked sweep.
+     */
+    void SyncHunts() {
+        hungry.assign(occupied.size(), 0);
+        for (size_t word = 0; word < occupied.size(); word++) {
+            for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                size_t i = word * 64 + __builtin_ctzll(bits);
+                if (!SpeciesHunts(species[i])) {
+                    continue;
+                }
+                hungry[word] |= uint64_t(1) << (i & 63);
+                for (size_t k = 0; k < params.huntProbes; k++) {
+                    size_t cell = SyncNeighbor(i, 2 + k);
+                    AE_COUNT(COUNTER_HUNT_PROBES);
+                    if (!TestOccupied<false>(cell) || !IsHunt(species[i], species[cell])) {
+                        continue;
+                    }
+                    if (hunter[cell] == NO_HUNTER) {
+                        hunter[cell] = (uint32_t) i;
+                        huntedCells.push_back(cell);
+                    }
+                    else if (strength[i] > strength[hunter[cell]]) {
+                        hunter[cell] = (uint32_t) i;
+                    }
+                }
+            }
+        }
+
+        huntOutcomes.resize(huntedCells.size());
+        for (size_t k = 0; k < huntedCells.size(); k++) {
+            size_t prey = huntedCells[k];
+            size_t predator = hunter[prey];
+            huntOutcomes[k] = Encounter(species[predator], strength[predator], species[prey], strength[prey], params);
+        }
+        for (size_t k = 0; k < huntedCells.size(); k++) {
+            size_t prey = huntedCells[k];
+            size_t predator = hunter[prey];
+            hunter[prey] = NO_HUNTER;
+            strength[predator] += huntOutcomes[k].firstGain;
+            strength[prey] += huntOutcomes[k].secondGain;
+            if (huntOutcomes[k].firstSurvives) { // predator kills and eats the prey
+                ClearOccupied<false>(prey);
+                hungry[predator >> 6] &= ~(uint64_t(1) << (predator & 63));
+                AE_COUNT(COUNTER_HUNT_KILLS);
+            }
+            else { // prey kills the predator
+                ClearOccupied<false>(predator);
+                AE_COUNT(COUNTER_HUNT_DEFEATS);
+            }
+        }
+        huntedCells.clear();
+
+        // predators that are still alive but haven't eaten any prey lose strength due to lack of food
+        for (size_t word = 0; word < occupied.size(); word++) {
+            hungry[word] &= occupied[word];
+            AE_COUNT_N(COUNTER_HUNT_MISSES, __builtin_popcountll(hungry[word]));
+        }
+        Sweeps::Starve(strength.data(), hungry.data(), hungry.size(), params.starvationLoss);
+    }
+
+
+    /**
+     * Synchronous reproduction: every organism with enough points makes an offspring, and once all have, each
+     * offspring is placed in the neighboring cell it drew, replacing any occupant, as births do in the asynchronous
+     * update. Of several offspring landing on one cell, the one arriving last (by a random draw) stays.
+     */
+    void SyncBirths() {
+        size_t birthDraw = 2 + params.huntProbes;
+        for (size_t word = 0; word < occupied.size(); word++) {
+            for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                size_t i = word * 64 + __builtin_ctzll(bits);
+                const SpeciesParams &speciesParams = params.Of(species[i]);
+                if (points[i] >= speciesParams.reproductionThreshold) {
+                    points[i] -= speciesParams.reproductionThreshold;
+                    births.push_back({SyncNeighbor(i, birthDraw), SyncDraw(i, birthDraw + 3), species[i],
+                                      strength[i] + speciesParams.mutationSigma * SyncNormal(i, birthDraw + 1)});
+                }
+            }
+        }
+
+        nextOccupied.assign(occupied.size(), 0); // cells that have received an offspring
+        for (const SyncBirth &birth : births) {
+            uint64_t bit = uint64_t(1) << (birth.cell & 63);
+            AE_COUNT(COUNTER_BIRTHS);
+            if (TestOccupied<false>(birth.cell)) {AE_COUNT(COUNTER_BIRTHS_OVERWRITING);}
+            if (!(nextOccupied[birth.cell >> 6] & bit) || birth.arrival > arrival[birth.cell]) {
+                nextOccupied[birth.cell >> 6] |= bit;
+                arrival[birth.cell] = birth.arrival;
+                Place<false>(birth.cell, birth.type, 0.0, birth.strength);
+            }
+        }
+        births.clear();
+    }
+
+    public:
+
+    CompactWorld(emp::Random &_random) : random(_random) {;}
+
+    size_t GetSize() const {return width * height;}
+    size_t GetWidth() const {return width;}
+    size_t GetHeight() const {return height;}
+    size_t GetUpdate() const {return update;}
+    emp::Random &GetRandom() {return random;}
+
+    bool IsOccupied(size_t i) const {return TestOccupied<false>(i);}
+    Species GetSpeciesAt(size_t i) const {return species[i];}
+    double GetPointsAt(size_t i) const {return points[i];}
+    double GetStrengthAt(size_t i) const {return strength[i];}
+
+
+    /**
+     * Turns on per-phase timing of Update(), accumulating into the given profile (or turns it off if null).
+     * The parallel update is not timed per phase.
+     * @param _profile The profile to accumulate into.
+     */
+    void SetProfile(PhaseProfile* _profile) {profile = _profile;}
+
+
+    /**
+     * Makes Update() use the tiled parallel schedule on the given pool (or the serial schedule if null).
+     * @param _threadPool The pool to run on.
+     */
+    void SetThreadPool(ThreadPool* _threadPool) {
+        threadPool = _threadPool;
+        if (threadPool) {tileSchedules.resize(threadPool->GetNumThreads());}
+    }
+
+
+    /**
+     * Chooses between shuffling every cell in the grid each pass of the serial update (the default, which keeps
+     * step with OrgWorld) and shuffling only the occupied cells, as OrgWorld::SetOccupiedOnlyScheduling does.
+     * The occupancy bitmap is already kept up to date, so the occupied cells are read from it a word at a time.
+     * @param _occupiedOnly true to schedule only occupied cells.
+     */
+    void SetOccupiedOnlyScheduling(bool _occupiedOnly) {occupiedOnly = _occupiedOnly;}
+
+
+    /**
+     * Chooses where movement, hunting, and birth draw their random neighbors from: the shared emp::Random, one
+     * draw and one wraparound calculation per neighbor (the default, which keeps step with OrgWorld), or a
+     * NeighborSampler, which takes batches of choices from a counter-based generator keyed by one draw of the
+     * shared generator per update (or per tile) and looks positions up in precomputed wraparound tables. The
+     * sampled neighbors follow the same distribution but a different sequence, so runs differ from the default.
+     * Grids must be at least 2 cells wide.
+     * @param on true to use the NeighborSampler.
+     */
+    void SetFastNeighborSampling(bool on) {fastNeighbors = on;}
+
+
+    /**
+     * Reports every move, interaction, death, and birth of the serial update to the given log (or stops
+     * reporting if null). The parallel update reports nothing.
+     * @param _replayLog The log to record to or check against.
+     */
+    void SetReplayLog(ReplayLog* _replayLog) {replayLog = _replayLog;}
+
+
+    /**
+     * Makes Update() run the synchronous step described at UpdateSynchronous() (or the usual asynchronous one).
+     * Grids must be at least 2 cells wide.
+     * @param on true to update synchronously.
+     */
+    void SetSynchronousUpdate(bool on) {synchronous = on;}
+
+
+    /**
+     * Places an organism at the given position, replacing any organism already there.
+     * @param i The position in the population.
+     * @param type The organism's species.
+     * @param _points The organism's reproduction points.
+     * @param _strength The organism's strength.
+     */
+    void AddOrgAt(size_t i, Species type, double _points, double _strength) {
+        Place<false>(i, type, _points, _strength);
+    }
+
+
+    /**
+     * Removes the organism at the given position, if there is one.
+     * @param i The position in the population.
+     */
+    void DoDeath(size_t i) {
+        ClearOccupied<false>(i);
+    }
+
+
+    /**
+     * Counts the organisms of a species currently in the world.
+     * @param type The species to count.
+     * @return The number of organisms of that species.
+     */
+    size_t CountSpecies(Species type) const {return speciesCount[(size_t) type];}
+
+
+    /**
+     * Checks whether the world has no organisms left.
+     * @return true if every cell is empty.
+     */
+    bool IsEmpty() const {
+        return std::all_of(speciesCount, speciesCount + NUM_SPECIES, [](size_t count) { return count == 0; });
+    }
+
+
+    /**
+     * Picks a random position in the 3x3 neighborhood (including the position itself) on the toroidal grid,
+     * matching emp::World::GetRandomNeighborPos for grid populations.
+     * @param i The position in the population.
+     * @return The neighboring position.
+     */
+    size_t GetRandomNeighborPos(size_t i) {
+        return NeighborOf(i, random);
+    }
+
+
+    /**
+     * Sizes the world as a toroidal grid and seeds it with predators and prey at random locations.
+     * @param _width The number of grid cells in each row.
+     * @param _height The number of grid cells in each column.
+     * @param numPredators The number of predators to add.
+     * @param numPrey The number of prey to add.
+     */
+    void Initialize(size_t _width, size_t _height, size_t numPredators, size_t numPrey) {
+        width = _width;
+        height = _height;
+        occupied.assign((GetSize() + 63) / 64, 0);
+        std::fill(speciesCount, speciesCount + NUM_SPECIES, 0);
+        sampler.Resize(width, height);
+        species.assign(GetSize(), Species::Org);
+        points.assign(GetSize(), 0.0);
+        strength.assign(GetSize(), 0.0);
+
+        for (size_t i = 0; i < numPredators; i++) {
+            double newStrength = params.Of(Species::Predator).initialStrength + DrawMutation(Species::Predator);
+            AddOrgAt(random.GetUInt(GetSize()-1), Species::Predator, 0.0, newStrength);
+        }
+        for (size_t i = 0; i < numPrey; i++) {
+            double newStrength = params.Of(Species::Prey).initialStrength + DrawMutation(Species::Prey);
+            AddOrgAt(random.GetUInt(GetSize()-1), Species::Prey, 0.0, newStrength);
+        }
+    }
+
+
+    /**
+     * Sizes the world as a toroidal grid and seeds it with the numbers of predators and prey set in its parameters.
+     * @param _width The number of grid cells in each row.
+     * @param _height The number of grid cells in each column.
+     */
+    void Initialize(size_t _width, size_t _height) {
+        Initialize(_width, _height, params.Of(Species::Predator).initialCount, params.Of(Species::Prey).initialCount);
+    }
+
+
+    const EcologyParams &GetParams() const {return params;}
+
+
+    /**
+     * Replaces the world's ecological parameters. Organisms already in the world keep their strength and points.
+     * @param _params The new parameters.
+     */
+    void SetParams(const EcologyParams &_params) {params = _params;}
+
+
+    /**
+     * Replaces the world's grid and organisms with the given per-cell state (as stored in a checkpoint).
+     * @param _width The number of grid cells in each row.
+     * @param _height The number of grid cells in each column.
+     * @param _update The update number to resume from.
+     * @param cells For each cell, 0 if empty or 1 + the occupant's Species.
+     * @param cellPoints Each occupant's reproduction points.
+     * @param cellStrength Each occupant's strength.
+     */
+    void Restore(size_t _width, size_t _height, size_t _update, const uint8_t* cells, const double* cellPoints,
+                 const double* cellStrength) {
+        width = _width;
+        height = _height;
+        update = _update;
+        occupied.assign((GetSize() + 63) / 64, 0);
+        sampler.Resize(width, height);
+        species.resize(GetSize());
+        points.assign(cellPoints, cellPoints + GetSize());
+        strength.assign(cellStrength, cellStrength + GetSize());
+        for (size_t i = 0; i < GetSize(); i++) {
+            species[i] = cells[i] ? (Species) (cells[i] - 1) : Species::Org;
+            if (cells[i]) {SetOccupied<false>(i);}
+        }
+        RecountSpecies();
+    }
+
+
+    /**
+     * Moves an organism to a random nearby position. As in OrgWorld, an occupant of that position interacts
+     * with the mover (predation or a fight) and is then displaced, and the mover takes the position.
+     * @param currentIndex The organism's current position in the population.
+     * @return The organism's new position in the population.
+     */
+    size_t MoveOrganism(size_t currentIndex) {
+        size_t newIndex;
+        WithNeighbors([&](auto &neighbors) { newIndex = MoveKernel<false>(currentIndex, neighbors); });
+        return newIndex;
+    }
+
+
+    /**
+     * Makes the predator at the given location hunt for sustenance, impacting organisms in nearby locations.
+     * @param predatorPosition The predator's current position in the population.
+     */
+    void ManageHuntingAtIdx(size_t predatorPosition) {
+        WithNeighbors([&](auto &neighbors) { HuntKernel<false>(predatorPosition, neighbors); });
+    }
+
+
+    /**
+     * Facilitates the death of the organism at the given location if its strength levels are low.
+     * @param currentIndex The organism's current position in the population.
+     */
+    void ManageDeathAtIdx(size_t currentIndex) {
+        DeathKernel<false>(currentIndex);
+    }
+
+
+    /**
+     * Checks the reproductive ability of the organism at the given location, placing offspring in a random location nearby if successful.
+     * @param currentIndex The organism's current position in the population.
+     */
+    void ManageReproductionAtIdx(size_t currentIndex) {
+        WithNeighbors([&](auto &neighbors) { ReproductionKernel<false>(currentIndex, random, neighbors); });
+    }
+
+
+    /**
+     * Parallel update. The grid is cut into an even number of tiles along each side (each at least
+     * MIN_TILE_SIDE cells) and the tiles are colored as a 2x2 checkerboard. The four colors run one after
+     * another; within a color the tiles are far enough apart that no two organisms' turns touch the same cell,
+     * so they run concurrently on the pool. Each tile shuffles and draws from its own generator, seeded from one
+     * draw of the shared generator per update, so a seed gives the same run for any number of threads (though
+     * not the same run as the serial schedule). Grids too small to tile fall back to the serial update.
+     *
+     * With a profile set, accrual is timed and the organisms that took a turn are counted, but the phases of a turn
+     * run interleaved across threads and aren't timed separately.
+     */
+    void UpdateParallel() {
+        size_t tilesX = TilesAlong(width);
+        size_t tilesY = TilesAlong(height);
+        if (tilesX == 0 || tilesY == 0) {
+            ThreadPool* pool = threadPool;
+            threadPool = nullptr;
+            Update();
+            threadPool = pool;
+            return;
+        }
+        AE_TRACE_SCOPE("update");
+        update++;
+
+        // as time passes, organism's ability to reproduce increases
+        const size_t WORDS_PER_TASK = 1024;
+        {
+            AE_TRACE_SCOPE("accrual");
+            PhaseTimer timer(profile, PHASE_ACCRUAL);
+            threadPool->ParallelFor((occupied.size() + WORDS_PER_TASK - 1) / WORDS_PER_TASK, [&](size_t task, size_t) {
+                size_t end = std::min(occupied.size(), (task + 1) * WORDS_PER_TASK);
+                for (size_t word = task * WORDS_PER_TASK; word < end; word++) {
+                    for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                        points[word * 64 + __builtin_ctzll(bits)] += params.pointsPerUpdate;
+                    }
+                }
+            });
+        }
+
+        uint64_t updateSeed = random.GetUInt64();
+        size_t tilesPerColor = (tilesX / 2) * (tilesY / 2);
+        for (size_t color = 0; color < 4; color++) {
+            AE_TRACE_SCOPE("color");
+            threadPool->ParallelFor(tilesPerColor, [&](size_t task, size_t worker) {
+                size_t tx = 2 * (task % (tilesX / 2)) + color % 2;
+                size_t ty = 2 * (task / (tilesX / 2)) + color / 2;
+                size_t tile = ty * tilesX + tx;
+                int seed = (int) ((Mix(updateSeed + tile) >> 33) | 1);
+                size_t turns = UpdateTile(tx * width / tilesX, (tx + 1) * width / tilesX,
+                                          ty * height / tilesY, (ty + 1) * height / tilesY, seed, tileSchedules[worker]);
+                if (profile) {__atomic_fetch_add(&profile->organismsProcessed, turns, __ATOMIC_RELAXED);}
+            });
+        }
+
+        {
+            AE_TRACE_SCOPE("census");
+            std::fill(speciesCount, speciesCount + NUM_SPECIES, 0);
+            threadPool->ParallelFor((occupied.size() + WORDS_PER_TASK - 1) / WORDS_PER_TASK, [&](size_t task, size_t) {
+                size_t counts[NUM_SPECIES] = {};
+                TallySpecies(task * WORDS_PER_TASK, std::min(occupied.size(), (task + 1) * WORDS_PER_TASK), counts);
+                for (size_t type = 0; type < NUM_SPECIES; type++) {
+                    __atomic_fetch_add(&speciesCount[type], counts[type], __ATOMIC_RELAXED);
+                }
+            });
+        }
+        AE_TRACE_COUNTERS();
+    }
+
+
+    /**
+     * Synchronous update. Rather than taking turns, every organism acts at once on the state left by the previous
+     * phase: all accrue points, all move (SyncMoves), all predators hunt (SyncHunts), the weak all die, and all
+     * that can reproduce do (SyncBirths), with conflicts settled by the deterministic rules given at each phase.
+     * Random choices come from counter-based draws per cell, keyed by one draw of the shared generator, so a seed
+     * gives the same run however the phases are computed. Accrual, starvation and death are masked sweeps over the
+     * whole grid, vectorized where the processor allows (see SimdSweeps.h).
+     *
+     * Its trajectories follow the same rules as the asynchronous update but not the same sequence, and it reports
+     * nothing to a replay log.
+     */
+    void UpdateSynchronous() {
+        AE_TRACE_SCOPE("update");
+        update++;
+        syncKey = random.GetUInt64();
+        syncDrawsPerCell = params.huntProbes + 6;
+        if (hunter.size() != GetSize()) {
+            nextSpecies.resize(GetSize());
+            nextPoints.resize(GetSize());
+            nextStrength.resize(GetSize());
+            arrival.resize(GetSize());
+            hunter.assign(GetSize(), NO_HUNTER);
+        }
+        if (profile) {
+            for (uint64_t word : occupied) {
+                profile->organismsProcessed += __builtin_popcountll(word);
+            }
+        }
+
+        {
+            AE_TRACE_SCOPE("accrual");
+            PhaseTimer timer(profile, PHASE_ACCRUAL);
+            // as time passes, organism's ability to reproduce increases
+            Sweeps::AccruePoints(points.data(), occupied.data(), occupied.size(), params.pointsPerUpdate);
+        }
+        {
+            AE_TRACE_SCOPE("moves");
+            PhaseTimer timer(profile, PHASE_MOVE);
+            SyncMoves();
+        }
+        {
+            AE_TRACE_SCOPE("hunts");
+            PhaseTimer timer(profile, PHASE_HUNT);
+            SyncHunts();
+        }
+        {
+            AE_TRACE_SCOPE("deaths");
+            PhaseTimer timer(profile, PHASE_DEATH);
+            size_t died = Sweeps::RemoveWeak(strength.data(), occupied.data(), occupied.size(), params.deathThreshold);
+            AE_COUNT_N(COUNTER_WEAKNESS_DEATHS, died);
+            (void) died;
+        }
+        {
+            AE_TRACE_SCOPE("births");
+            PhaseTimer timer(profile, PHASE_REPRODUCTION);
+            SyncBirths();
+        }
+        RecountSpecies();
+        AE_TRACE_COUNTERS();
+    }
+
+
+    /**
+     * Updates reproduction points and strength levels for each organism and faciliates movement, hunting, death, and reproduction.
+     */
+    void Update() {
+        if (synchronous) {
+            UpdateSynchronous();
+            return;
+        }
+        if (threadPool) {
+            UpdateParallel();
+            return;
+        }
+
+        AE_TRACE_SCOPE("update");
+        update++;
+        if (replayLog) {replayLog->Record(ReplayEventType::Update, Species::Org, update, 0, 0.0);}
+        if (fastNeighbors) {stream.Reset(random.GetUInt64());}
+        {
+            AE_TRACE_SCOPE("accrual");
+            PhaseTimer timer(profile, PHASE_ACCRUAL);
+            // OrgWorld shuffles this pass; the order doesn't affect the result, but with the full schedule the
+            // draws are kept so the generator stays in step with OrgWorld
+            if (!occupiedOnly) {
+                for (size_t i = 1; i < GetSize(); i++) {
+                    random.GetUInt(i+1);
+                }
+            }
+            for (size_t word = 0; word < occupied.size(); word++) {
+                for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                    points[word * 64 + __builtin_ctzll(bits)] += params.pointsPerUpdate; // as time passes, organism's ability to reproduce increases
+                }
+            }
+        }
+
+        // permutation ensures that organisms early in the population don't have an advantage
+        if (occupiedOnly) {
+            occupiedCells.clear();
+            for (size_t word = 0; word < occupied.size(); word++) {
+                for (uint64_t bits = occupied[word]; bits; bits &= bits - 1) {
+                    occupiedCells.push_back(word * 64 + __builtin_ctzll(bits));
+                }
+            }
+        }
+        AE_TRACE_SCOPE("turns");
+        const emp::vector<size_t> &schedule = occupiedOnly ? scheduler.Shuffle(random, occupiedCells)
+                                                           : scheduler.Permutation(random, GetSize());
+        for (size_t i : schedule) {
+            if (!IsOccupied(i)) {
+                continue;
+            }
+            if (profile) {profile->organismsProcessed++;}
+
+            // moves organism and executes changes (hunting, death, and reproduction) at its new position
+            bool hunts = SpeciesHunts(species[i]);
+            size_t newIndex;
+            {
+                PhaseTimer timer(profile, PHASE_MOVE);
+                newIndex = MoveOrganism(i);
+            }
+            if (hunts) {
+                PhaseTimer timer(profile, PHASE_HUNT);
+                ManageHuntingAtIdx(newIndex);
+            }
+            {
+                PhaseTimer timer(profile, PHASE_DEATH);
+                ManageDeathAtIdx(newIndex);
+            }
+            {
+                PhaseTimer timer(profile, PHASE_REPRODUCTION);
+                ManageReproductionAtIdx(newIndex);
+            }
+        }
+        AE_TRACE_COUNTERS();
+    }
+
+};
+#endif
@@ -0,0 +1,83 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "emp/base/vector.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * A finished picture of the grid, one RGBA pixel per cell, and the update it shows.
+ */
+struct Frame {
+    emp::vector<uint8_t> pixels;
+    size_t update = 0;
+};
+
+
+/**
+ * Hands frames from the simulation thread to the rendering thread without either one waiting for the other. It
+ * is a ring of three frames: the producer always owns one to draw into, the consumer always owns one to read
+ * from, and the third holds the newest finished frame. Publishing swaps the producer's frame with the newest one,
+ * and taking swaps the consumer's frame with it, each in one atomic exchange, so a slow consumer simply skips the
+ * frames it never took and a slow producer leaves the consumer showing the last one.
+ */
+class FrameRing {
+    static constexpr uint8_t INDEX_MASK = 3;
+    static constexpr uint8_t FRESH = 4; // set while the newest frame hasn't been taken
+
+    Frame frames[3];
+    uint8_t producerFrame = 0;
+    uint8_t consumerFrame = 1;
+    std::atomic<uint8_t> newest{2};
+
+    public:
+
+        /**
+         * Sizes every frame for a grid with the given number of cells, discarding their contents. Call it only
+         * while neither thread is using the ring.
+         * @param numCells The number of grid cells.
+         */
+        void Resize(size_t numCells) {
+            for (Frame &frame : frames) {
+                frame.pixels.assign(numCells * 4, 0);
+                frame.update = 0;
+            }
+            newest.store(2);
+        }
+
+
+        /**
+         * @return The frame the producer may draw into (its contents are whatever was drawn there last).
+         */
+        Frame &ProducerFrame() {return frames[producerFrame];}
+
+
+        /**
+         * Makes the producer's frame the newest, and gives the producer a free frame to draw the next one into.
+         */
+        void Publish() {
+            producerFrame = newest.exchange(producerFrame | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+
+
+        /**
+         * @return true if a frame was published since the consumer last took one.
+         */
+        bool HasFresh() const {return newest.load(std::memory_order_acquire) & FRESH;}
+
+
+        /**
+         * Takes the newest frame, if one was published since the last call.
+         * @return The newest frame, or null if there is nothing new.
+         */
+        const Frame* Take() {
+            if (!HasFresh()) {
+                return nullptr;
+            }
+            consumerFrame = newest.exchange(consumerFrame, std::memory_order_acq_rel) & INDEX_MASK;
+            return &frames[consumerFrame];
+        }
+};
+#endif
@@ -0,0 +1,208 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "emp/base/vector.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+
+/**
+ * Optional instrumentation of the update loop: event counters and scoped timers, kept per thread and exported as
+ * a Chrome trace (open it at chrome://tracing or https://ui.perfetto.dev). It is compiled in only when
+ * AE_INSTRUMENT is defined to 1 (add -DAE_INSTRUMENT=1 to the build); otherwise the AE_COUNT, AE_COUNT_N,
+ * AE_TRACE_SCOPE, and AE_TRACE_COUNTERS macros expand to nothing and the update loop is exactly as fast as without them.
+ */
+#ifndef AE_INSTRUMENT
+#define AE_INSTRUMENT 0
+#endif
+
+
+/**
+ * The events counted by AE_COUNT.
+ */
+enum Counter {
+    COUNTER_MOVES,                 // organisms moved
+    COUNTER_MOVES_ONTO_OCCUPIED,   // moves into an occupied cell, which start an encounter
+    COUNTER_ENCOUNTER_HUNTS,       // encounters resolved as a hunt
+    COUNTER_ENCOUNTER_FIGHTS,      // encounters resolved as a fight
+    COUNTER_HUNT_PROBES,           // cells checked by hunting predators
+    COUNTER_HUNT_KILLS,            // prey killed by hunting predators
+    COUNTER_HUNT_DEFEATS,          // hunting predators killed by stronger prey
+    COUNTER_HUNT_MISSES,           // hunting predators that found nothing to eat and starved a little
+    COUNTER_WEAKNESS_DEATHS,       // organisms removed for falling below the death threshold
+    COUNTER_BIRTHS,                // offspring placed
+    COUNTER_BIRTHS_OVERWRITING,    // births into an occupied cell, replacing its occupant
+    COUNTER_BIRTHS_OVER_PARENT,    // births into the parent's own cell, replacing the parent
+    NUM_COUNTERS
+};
+
+
+/**
+ * Per-thread counters and trace events, collected across all threads for export.
+ */
+class Instrument {
+    public:
+        struct TraceEvent {
+            const char* name;
+            double start;    // microseconds since the trace epoch
+            double duration; // microseconds
+        };
+
+        struct ThreadData {
+            size_t threadId;
+            size_t counters[NUM_COUNTERS] = {};
+            emp::vector<TraceEvent> events;
+            emp::vector<std::pair<double, emp::vector<size_t>>> counterSamples; // (time, totals) per sample
+        };
+
+    private:
+        static std::mutex &Mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        static emp::vector<std::unique_ptr<ThreadData>> &Threads() {
+            static emp::vector<std::unique_ptr<ThreadData>> threads;
+            return threads;
+        }
+
+        static std::chrono::steady_clock::time_point Epoch() {
+            static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+            return epoch;
+        }
+
+    public:
+
+        static const char* CounterName(int counter) {
+            static const char* names[NUM_COUNTERS] = {
+                "moves", "moves_onto_occupied", "encounter_hunts", "encounter_fights", "hunt_probes", "hunt_kills",
+                "hunt_defeats", "hunt_misses", "weakness_deaths", "births", "births_overwriting", "births_over_parent"};
+            return names[counter];
+        }
+
+
+        /**
+         * @return The calling thread's data, registered on first use. It outlives the thread, so counts from
+         * finished worker threads are still exported.
+         */
+        static ThreadData &Local() {
+            thread_local ThreadData* local = nullptr;
+            if (local == nullptr) {
+                std::lock_guard<std::mutex> lock(Mutex());
+                Threads().emplace_back(new ThreadData);
+                local = Threads().back().get();
+                local->threadId = Threads().size() - 1;
+            }
+            return *local;
+        }
+
+
+        /**
+         * @return Microseconds since the trace epoch.
+         */
+        static double Now() {
+            return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Epoch()).count();
+        }
+
+
+        /**
+         * Sums each counter over every thread. Call it between updates, when no other thread is counting.
+         * @return The totals, indexed by Counter.
+         */
+        static emp::vector<size_t> Totals() {
+            emp::vector<size_t> totals(NUM_COUNTERS, 0);
+            std::lock_guard<std::mutex> lock(Mutex());
+            for (const std::unique_ptr<ThreadData> &thread : Threads()) {
+                for (size_t c = 0; c < NUM_COUNTERS; c++) {
+                    totals[c] += thread->counters[c];
+                }
+            }
+            return totals;
+        }
+
+
+        /**
+         * Adds the current counter totals to the trace, where they are drawn as a graph over time.
+         */
+        static void RecordCounters() {
+            emp::vector<size_t> totals = Totals();
+            Local().counterSamples.emplace_back(Now(), totals);
+        }
+
+
+        /**
+         * Writes every thread's timed scopes and the recorded counter totals as a Chrome trace-event JSON file.
+         * @param path Where to write the trace.
+         * @param error Set to a description of the problem if writing fails.
+         * @return true if the trace was written.
+         */
+        static bool WriteChromeTrace(const std::string &path, std::string &error) {
+            FILE* file = std::fopen(path.c_str(), "w");
+            if (file == nullptr) {
+                error = "cannot open " + path + " for writing";
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(Mutex());
+            std::fprintf(file, "{\"traceEvents\":[\n");
+            const char* separator = "";
+            for (const std::unique_ptr<ThreadData> &thread : Threads()) {
+                std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,"
+                                   "\"args\":{\"name\":\"thread %zu\"}}", separator, thread->threadId, thread->threadId);
+                separator = ",\n";
+                for (const TraceEvent &event : thread->events) {
+                    std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                                 separator, event.name, thread->threadId, event.start, event.duration);
+                }
+                for (const auto &sample : thread->counterSamples) {
+                    std::fprintf(file, "%s{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"args\":{",
+                                 separator, thread->threadId, sample.first);
+                    for (size_t c = 0; c < NUM_COUNTERS; c++) {
+                        std::fprintf(file, "%s\"%s\":%zu", c ? "," : "", CounterName(c), sample.second[c]);
+                    }
+                    std::fprintf(file, "}}");
+                }
+            }
+            std::fprintf(file, "\n]}\n");
+            if (std::fclose(file) != 0) {
+                error = "failed writing " + path;
+                return false;
+            }
+            return true;
+        }
+};
+
+
+/**
+ * Records the time it is in scope as a trace event on the calling thread.
+ */
+class TraceScope {
+    const char* name;
+    double start;
+
+    public:
+        TraceScope(const char* _name) : name(_name), start(Instrument::Now()) {;}
+        ~TraceScope() {Instrument::Local().events.push_back({name, start, Instrument::Now() - start});}
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+};
+
+
+#define AE_INSTRUMENT_CONCAT_(a, b) a##b
+#define AE_INSTRUMENT_CONCAT(a, b) AE_INSTRUMENT_CONCAT_(a, b)
+
+#if AE_INSTRUMENT
+#define AE_COUNT(counter) (Instrument::Local().counters[counter]++)
+#define AE_COUNT_N(counter, n) (Instrument::Local().counters[counter] += (n))
+#define AE_TRACE_SCOPE(name) TraceScope AE_INSTRUMENT_CONCAT(traceScope, __LINE__)(name)
+#define AE_TRACE_COUNTERS() Instrument::RecordCounters()
+#else
+#define AE_COUNT(counter) ((void) 0)
+#define AE_COUNT_N(counter, n) ((void) 0)
+#define AE_TRACE_SCOPE(name) ((void) 0)
+#define AE_TRACE_COUNTERS() ((void) 0)
+#endif
+#endif
@@ -0,0 +1,235 @@
+#ifndef LINEAGE_H
+#define LINEAGE_H
+
+#include "emp/base/vector.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "Species.h"
+
+
+/**
+ * One organism's entry in a Lineage: its parent and children, and its species and strength when it was born.
+ */
+struct LineageNode {
+    uint32_t parent;      // Lineage::NONE for a founder, or once every ancestor has been removed
+    uint32_t firstChild;
+    uint32_t nextSibling; // also links unused nodes into the free list
+    uint32_t prevSibling;
+    uint32_t numChildren;
+    uint32_t generation;  // births between the node and its founder, kept when ancestors are spliced out
+    uint64_t birthUpdate;
+    double strength;      // strength at birth, after mutation
+    Species species;
+    uint8_t state;        // one of Lineage's FREE, DEAD, or LIVING
+};
+
+
+/**
+ * The ancestry of the organisms in a world, as a tree of births. Each organism holds the index of its node, which
+ * records its parent, species, generation, and strength at birth, so how strength evolved along any lineage can be
+ * read back from the living organisms to their founders.
+ *
+ * Nodes live in one arena and are recycled through a free list, so adding a birth costs a few stores and no
+ * allocation once the arena has grown to its peak. When an organism dies its node is pruned if it has no
+ * descendants left, and so is each ancestor left childless in turn; a dead ancestor left with a single child is
+ * spliced out, the child taking its place. What remains is the reconstructed tree of the living organisms: the
+ * living plus the most recent common ancestor of every pair of them, never more than twice the living population
+ * however many births a run has, with each node's generation and birth update still giving the distance between
+ * the branch points kept.
+ */
+class Lineage {
+    static constexpr uint8_t FREE = 0;
+    static constexpr uint8_t DEAD = 1;
+    static constexpr uint8_t LIVING = 2;
+
+    emp::vector<LineageNode> nodes;
+    uint32_t freeList = NONE;
+    size_t numNodes = 0;  // nodes in the tree, living or dead
+    size_t numLiving = 0;
+    size_t numBirths = 0; // nodes ever added, founders included
+
+    /**
+     * Takes a node from the free list, or grows the arena if it is empty.
+     * @return The node's index.
+     */
+    uint32_t Allocate() {
+        uint32_t id = freeList;
+        if (id == NONE) {
+            id = (uint32_t) nodes.size();
+            nodes.emplace_back();
+        }
+        else {
+            freeList = nodes[id].nextSibling;
+        }
+        numNodes++;
+        return id;
+    }
+
+
+    void Free(uint32_t id) {
+        nodes[id].state = FREE;
+        nodes[id].nextSibling = freeList;
+        freeList = id;
+        numNodes--;
+    }
+
+
+    void LinkChild(uint32_t parent, uint32_t child) {
+        LineageNode &node = nodes[child];
+        node.parent = parent;
+        node.prevSibling = NONE;
+        node.nextSibling = NONE;
+        if (parent == NONE) {
+            return;
+        }
+        node.nextSibling = nodes[parent].firstChild;
+        if (node.nextSibling != NONE) {nodes[node.nextSibling].prevSibling = child;}
+        nodes[parent].firstChild = child;
+        nodes[parent].numChildren++;
+    }
+
+
+    void UnlinkChild(uint32_t child) {
+        LineageNode &node = nodes[child];
+        if (node.parent == NONE) {
+            return;
+        }
+        if (node.prevSibling != NONE) {nodes[node.prevSibling].nextSibling = node.nextSibling;}
+        else {nodes[node.parent].firstChild = node.nextSibling;}
+        if (node.nextSibling != NONE) {nodes[node.nextSibling].prevSibling = node.prevSibling;}
+        nodes[node.parent].numChildren--;
+        node.parent = NONE;
+    }
+
+
+    /**
+     * Removes a dead node that no longer tells anything about the living: a childless one (and then its ancestors,
+     * as they become childless), or one with a single child, which takes its place under its parent.
+     * @param id The node.
+     */
+    void Prune(uint32_t id) {
+        while (nodes[id].state == DEAD) {
+            uint32_t parent = nodes[id].parent;
+            if (nodes[id].numChildren == 1) {
+                uint32_t child = nodes[id].firstChild;
+                UnlinkChild(child);
+                UnlinkChild(id);
+                LinkChild(parent, child);
+                Free(id);
+                return;
+            }
+            if (nodes[id].numChildren > 1) {
+                return;
+            }
+            UnlinkChild(id);
+            Free(id);
+            if (parent == NONE) {
+                return;
+            }
+            id = parent;
+        }
+    }
+
+    public:
+
+        static constexpr uint32_t NONE = UINT32_MAX; // no node
+
+        /**
+         * Adds an organism with no recorded parent, such as one placed when the world is seeded.
+         * @param species The organism's species.
+         * @param strength Its strength.
+         * @param update The update it appeared in.
+         * @return Its node.
+         */
+        uint32_t AddFounder(Species species, double strength, size_t update) {
+            return AddBirth(NONE, species, strength, update);
+        }
+
+
+        /**
+         * Adds a newborn organism under its parent.
+         * @param parent The parent's node (or NONE for a founder).
+         * @param species The offspring's species.
+         * @param strength Its strength at birth.
+         * @param update The update it was born in.
+         * @return Its node.
+         */
+        uint32_t AddBirth(uint32_t parent, Species species, double strength, size_t update) {
+            uint32_t id = Allocate();
+            LineageNode &node = nodes[id];
+            node.firstChild = NONE;
+            node.numChildren = 0;
+            node.generation = parent == NONE ? 0 : nodes[parent].generation + 1;
+            node.birthUpdate = update;
+            node.strength = strength;
+            node.species = species;
+            node.state = LIVING;
+            LinkChild(parent, id);
+            numLiving++;
+            numBirths++;
+            return id;
+        }
+
+
+        /**
+         * Records an organism's death, pruning whatever of its ancestry no longer leads to a living organism.
+         * @param id The organism's node (NONE is ignored).
+         */
+        void Remove(uint32_t id) {
+            if (id == NONE || nodes[id].state != LIVING) {
+                return;
+            }
+            nodes[id].state = DEAD;
+            numLiving--;
+            Prune(id);
+        }
+
+
+        /**
+         * Forgets every node, as when the world is reseeded.
+         */
+        void Clear() {
+            nodes.clear();
+            freeList = NONE;
+            numNodes = numLiving = numBirths = 0;
+        }
+
+
+        const LineageNode &Get(uint32_t id) const {return nodes[id];}
+        bool IsLiving(uint32_t id) const {return nodes[id].state == LIVING;}
+        size_t GetNumNodes() const {return numNodes;}
+        size_t GetNumLiving() const {return numLiving;}
+        size_t GetNumBirths() const {return numBirths;}
+        size_t GetMemoryBytes() const {return nodes.capacity() * sizeof(LineageNode);}
+
+
+        /**
+         * Writes the tree as CSV, one row per node: id, parent (empty for a root), species, birth update,
+         * generation, strength at birth, and whether the organism is alive.
+         * @param path Where to write the file.
+         * @param error Set to a description of the problem if writing fails.
+         * @return true if the file was written.
+         */
+        bool Write(const std::string &path, std::string &error) const {
+            FILE* file = std::fopen(path.c_str(), "w");
+            if (file == nullptr) {
+                error = "cannot open " + path + " for writing";
+                return false;
+            }
+            std::fprintf(file, "id,parent,species,birth_update,generation,strength,living\n");
+            for (uint32_t id = 0; id < nodes.size(); id++) {
+                const LineageNode &node = nodes[id];
+                if (node.state == FREE) {continue;}
+                std::fprintf(file, "%u,", id);
+                if (node.parent != NONE) {std::fprintf(file, "%u", node.parent);}
+                std::fprintf(file, ",%s,%llu,%u,%.6g,%d\n", SpeciesName(node.species),
+                             (unsigned long long) node.birthUpdate, node.generation, node.strength,
+                             node.state == LIVING);
+            }
+            bool written = std::fclose(file) == 0;
+            if (!written) {error = "failed writing " + path;}
+            return written;
+        }
+};
+#endif
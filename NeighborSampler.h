@@ -0,0 +1,197 @@
+#ifndef NEIGHBOR_SAMPLER_H
+#define NEIGHBOR_SAMPLER_H
+
+#include "emp/base/vector.hpp"
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * A counter-based generator: the n-th output is a hash of (key, n), here the splitmix64 sequence started at key.
+ * Outputs don't depend on each other, so a batch of them can be computed in one vectorizable loop, and a stream
+ * is fully described by its key and counter.
+ */
+class CounterRandom {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+
+    public:
+        CounterRandom(uint64_t _key = 0) : key(_key) {;}
+
+        void Reset(uint64_t _key) {
+            key = _key;
+            counter = 0;
+        }
+
+
+        /**
+         * @return The output at the given position of the stream with the given key.
+         */
+        static uint64_t Hash(uint64_t key, uint64_t n) {
+            uint64_t value = key + (n + 1) * 0x9e3779b97f4a7c15ULL;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            return value ^ (value >> 31);
+        }
+
+        uint64_t Next() {return Hash(key, counter++);}
+
+
+        /**
+         * Writes the next count outputs.
+         * @param out Where to write them.
+         * @param count How many to write.
+         */
+        void Fill(uint64_t* out, size_t count) {
+            for (size_t k = 0; k < count; k++) {
+                out[k] = Hash(key, counter + k);
+            }
+            counter += count;
+        }
+};
+
+
+/**
+ * A stream of neighbor choices in [0, 9), numbered as emp::World numbers a cell's 3x3 neighborhood
+ * (x offset choice % 3 - 1, y offset choice / 3 - 1). Choices are made a batch at a time, two per 64-bit output
+ * of a CounterRandom, using a 32-bit multiply-shift so no division or rejection loop is needed.
+ */
+class NeighborStream {
+    static constexpr size_t BATCH = 64;
+
+    CounterRandom random;
+    uint8_t choices[BATCH];
+    size_t next = BATCH;
+
+
+    void Refill() {
+        uint64_t words[BATCH / 2];
+        random.Fill(words, BATCH / 2);
+        for (size_t k = 0; k < BATCH / 2; k++) {
+            choices[2 * k] = (uint8_t) (((words[k] & 0xffffffffULL) * 9) >> 32);
+            choices[2 * k + 1] = (uint8_t) (((words[k] >> 32) * 9) >> 32);
+        }
+        next = 0;
+    }
+
+    public:
+        NeighborStream(uint64_t key = 0) : random(key) {;}
+
+
+        /**
+         * Restarts the stream with a new key.
+         * @param key The key.
+         */
+        void Reset(uint64_t key) {
+            random.Reset(key);
+            next = BATCH;
+        }
+
+        unsigned Next() {
+            if (next == BATCH) {Refill();}
+            return choices[next++];
+        }
+};
+
+
+/**
+ * Turns neighbor choices into positions on a toroidal grid. The wrapped column and row of every cell's
+ * neighbors are precomputed, and positions are split into column and row with a multiply instead of a division,
+ * so a neighbor costs two table lookups and an add.
+ */
+class NeighborSampler {
+    static constexpr uint8_t COLUMN_OF_CHOICE[9] = {0, 1, 2, 0, 1, 2, 0, 1, 2};
+    static constexpr uint8_t ROW_OF_CHOICE[9] = {0, 0, 0, 1, 1, 1, 2, 2, 2};
+
+    uint32_t width = 0;
+    uint64_t widthReciprocal = 0; // ceil(2^64 / width), for division by multiplication
+    emp::vector<uint32_t> columns; // for each column x: the wrapped x - 1, x, x + 1
+    emp::vector<uint32_t> rows;    // for each row y: the first position of the wrapped rows y - 1, y, y + 1
+
+
+    uint32_t ColumnOf(uint32_t i) const {
+        return (uint32_t) (((__uint128_t) (widthReciprocal * i) * width) >> 64);
+    }
+
+    uint32_t RowOf(uint32_t i) const {
+        return (uint32_t) (((__uint128_t) widthReciprocal * i) >> 64);
+    }
+
+    public:
+
+        /**
+         * Sets up the tables for a grid of the given size, which must have fewer than 2^32 cells.
+         * @param _width The number of grid cells in each row.
+         * @param height The number of grid cells in each column.
+         */
+        void Resize(size_t _width, size_t height) {
+            width = (uint32_t) _width;
+            widthReciprocal = UINT64_MAX / width + 1;
+            columns.resize(3 * _width);
+            for (size_t x = 0; x < _width; x++) {
+                columns[3 * x] = (uint32_t) (x == 0 ? _width - 1 : x - 1);
+                columns[3 * x + 1] = (uint32_t) x;
+                columns[3 * x + 2] = (uint32_t) (x + 1 == _width ? 0 : x + 1);
+            }
+            rows.resize(3 * height);
+            for (size_t y = 0; y < height; y++) {
+                rows[3 * y] = (uint32_t) ((y == 0 ? height - 1 : y - 1) * _width);
+                rows[3 * y + 1] = (uint32_t) (y * _width);
+                rows[3 * y + 2] = (uint32_t) ((y + 1 == height ? 0 : y + 1) * _width);
+            }
+        }
+
+
+        /**
+         * @param i The position in the population.
+         * @param choice Which of the 9 cells in the 3x3 neighborhood (including the position itself).
+         * @return The neighboring position.
+         */
+        size_t Neighbor(size_t i, unsigned choice) const {
+            uint32_t x = ColumnOf((uint32_t) i);
+            uint32_t y = RowOf((uint32_t) i);
+            return columns[3 * x + COLUMN_OF_CHOICE[choice]] + rows[3 * y + ROW_OF_CHOICE[choice]];
+        }
+
+
+        /**
+         * Lists the 8 cells around a position, clockwise from the top left, so corners come at even indices and
+         * sides at odd ones.
+         * @param i The position in the population.
+         * @param out Where to write the neighboring positions.
+         */
+        void Ring(size_t i, size_t out[8]) const {
+            static constexpr uint8_t CHOICE_OF_RING[8] = {0, 1, 2, 5, 8, 7, 6, 3};
+            const uint32_t* column = &columns[3 * ColumnOf((uint32_t) i)];
+            const uint32_t* row = &rows[3 * RowOf((uint32_t) i)];
+            for (size_t k = 0; k < 8; k++) {
+                out[k] = column[COLUMN_OF_CHOICE[CHOICE_OF_RING[k]]] + row[ROW_OF_CHOICE[CHOICE_OF_RING[k]]];
+            }
+        }
+
+
+        /**
+         * @return A random neighbor of position i, drawn from the stream.
+         */
+        size_t Neighbor(size_t i, NeighborStream &stream) const {
+            return Neighbor(i, stream.Next());
+        }
+
+
+        /**
+         * Draws four random neighbors of one position at once, as a predator's hunting probes do. The position is
+         * split into column and row once, and the four lookups are independent, so they can be issued together.
+         * @param i The position in the population.
+         * @param stream The stream to draw from.
+         * @param out Where to write the four neighboring positions.
+         */
+        void Sample4(size_t i, NeighborStream &stream, size_t out[4]) const {
+            unsigned choice[4] = {stream.Next(), stream.Next(), stream.Next(), stream.Next()};
+            const uint32_t* column = &columns[3 * ColumnOf((uint32_t) i)];
+            const uint32_t* row = &rows[3 * RowOf((uint32_t) i)];
+            for (size_t k = 0; k < 4; k++) {
+                out[k] = column[COLUMN_OF_CHOICE[choice[k]]] + row[ROW_OF_CHOICE[choice[k]]];
+            }
+        }
+};
+#endif
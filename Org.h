@@ -3,21 +3,39 @@
 
 #include "emp/math/Random.hpp"
 #include "emp/tools/string_utils.hpp"
+#include "OrganismPool.h"
+#include "Params.h"
+#include "Species.h"
+#include <cstdint>
 #include <string>
 
 
 /**
  * Creates an Organism with the ability to reproduce, mutate, and vary reproduction points and strength.
+ *
+ * Mutations draw from the generator they are given by reference, so each mutation advances the world's shared
+ * generator and siblings receive independent mutations. Because every draw in the model comes from that one
+ * generator in schedule order, a run is fully determined by its seed and settings.
+ *
+ * The ecological constants (reproduction thresholds, mutation sizes, fight bonus) come from the world's
+ * EcologyParams, which are passed to each method that needs them.
  */
 class Organism {
     private:
         double points; // points for reproductive ability/maturity
         emp::Ptr<emp::Random> random;
         double strength; // points for strength (hunting, fighting, and overall survival)
+        Species species;
+        uint32_t lineage = UINT32_MAX; // node in the world's Lineage, if it keeps one (copied to offspring)
+
+    protected:
+        Organism(emp::Ptr<emp::Random> _random, double _points, double _strength, Species _species) :
+            points(_points), random(_random), strength(_strength), species(_species){;}
 
     public:
         Organism(emp::Ptr<emp::Random> _random, double _points = 1000.0, double _strength = 500.0) :
-            points(_points), random(_random), strength(_strength){;}
+            points(_points), random(_random), strength(_strength), species(Species::Org){;}
+        virtual ~Organism() {;}
 
         void SetPoints(double _in) {points = _in;}
         double GetPoints() {return points;}
@@ -28,19 +46,25 @@ class Organism {
 
         emp::Ptr<emp::Random> GetRandom() {return random;}
 
-        virtual std::string GetType() {return "Org";}
+        Species GetSpecies() const {return species;}
+        uint32_t GetLineage() const {return lineage;}
+        void SetLineage(uint32_t _in) {lineage = _in;}
+        std::string GetType() const {return SpeciesName(species);}
 
 
         /**
          * If an Organism can reproduce, creates its offspring.
+         * @param pool The pool the offspring is allocated from.
+         * @param params The world's ecological parameters.
          * @return Pointer to offspring (null pointer if the Organism cannot reproduce)
          */
-        virtual emp::Ptr<Organism> CheckReproduction() {
-            if (points >= 1000) { // Organism has sufficient reproduction points
-                emp::Ptr<Organism> offspring = new Organism(*this);
-                offspring->mutate(*random);
+        virtual emp::Ptr<Organism> CheckReproduction(OrganismPool &pool, const EcologyParams &params) {
+            double threshold = params.Of(species).reproductionThreshold;
+            if (points >= threshold) { // Organism has sufficient reproduction points
+                emp::Ptr<Organism> offspring = pool.New<Organism>(*this);
+                offspring->mutate(*random, params);
                 offspring->points = 0.0;
-                points -= 1000;
+                points -= threshold;
                 return offspring;
             }
             else { // Organism cannot reproduce yet
@@ -50,11 +74,12 @@ class Organism {
 
         
         /**
-         * Mutates an Organism's strength value by a small, pseudorandom amount
-         * @param random Pseudorandom number generator
+         * Mutates an Organism's strength value by a small, pseudorandom amount, sized by its species
+         * @param random Pseudorandom number generator, advanced by the draw (pass the world's shared generator)
+         * @param params The world's ecological parameters.
          */
-        virtual void mutate(emp::Random random) {
-            double randomNum = random.GetRandNormal(0.0, 5.0);
+        virtual void mutate(emp::Random &random, const EcologyParams &params) {
+            double randomNum = random.GetRandNormal(0.0, params.Of(species).mutationSigma);
             strength += randomNum;
         }
 
@@ -64,16 +89,17 @@ class Organism {
          * @param org2 The second organism in the fight.
          * @param org1Position The first organism's position in the population.
          * @param org2Position The second organism's position in the population.
+         * @param params The world's ecological parameters.
          * @return position of the organism that will die.
          */
-        int Fight(Organism* org2, int org1Position, int org2Position) {
+        int Fight(Organism* org2, int org1Position, int org2Position, const EcologyParams &params) {
             // the stronger organism wins the fight
             if (GetStrength() >= org2->GetStrength()) {
-                AddStrength(0.05 * org2->GetStrength());
+                AddStrength(params.fightBonus * org2->GetStrength());
                 return org2Position;
             }
             else {
-                org2->AddStrength(0.05 * GetStrength());
+                org2->AddStrength(params.fightBonus * GetStrength());
                 return org1Position;
             }
         }
@@ -84,12 +110,21 @@ class Organism {
          * @param org2 The second organism in the interaction.
          * @param org1Position The first organism's position in the population.
          * @param org2Position The second organism's position in the population.
+         * @param params The world's ecological parameters.
          * @return position of the organism that will die.
          */
-        virtual int Interact(Organism* org2, int org1Position, int org2Position) {
-            int indexToDie = Fight(org2, org1Position, org2Position);
+        virtual int Interact(Organism* org2, int org1Position, int org2Position, const EcologyParams &params) {
+            int indexToDie = Fight(org2, org1Position, org2Position, params);
             return indexToDie;
         }
         
 };
-#endif
\ No newline at end of file
+
+
+/**
+ * The Organism class that represents each species, so species-specialized code can create organisms of the right
+ * class. Species with their own class specialize this next to the class.
+ */
+template <Species S>
+struct SpeciesClass {using type = Organism;};
+#endif
@@ -0,0 +1,87 @@
+#ifndef ORGANISM_POOL_H
+#define ORGANISM_POOL_H
+
+#include "emp/base/vector.hpp"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+/**
+ * A slab allocator for organisms. Memory is taken from the heap a slab of slots at a time, and the slots of
+ * organisms that die are kept on a free list and reused for the next births.
+ */
+class OrganismPool {
+    static constexpr size_t SLOT_SIZE = 64;       // bytes per organism; every organism type must fit
+    static constexpr size_t SLOTS_PER_SLAB = 1024;
+
+    union Slot {
+        Slot* next; // link to the next free slot while the slot is unused
+        alignas(std::max_align_t) unsigned char storage[SLOT_SIZE];
+    };
+
+    emp::vector<std::unique_ptr<Slot[]>> slabs;
+    Slot* freeList = nullptr;
+    size_t numCreated = 0; // organisms created over the pool's lifetime
+
+    /**
+     * Takes a slot from the free list, adding a new slab first if the list is empty.
+     * @return Pointer to uninitialized storage for one organism.
+     */
+    void* Allocate() {
+        if (freeList == nullptr) {
+            slabs.emplace_back(new Slot[SLOTS_PER_SLAB]);
+            Slot* slab = slabs.back().get();
+            for (size_t i = 0; i < SLOTS_PER_SLAB; i++) {
+                slab[i].next = freeList;
+                freeList = &slab[i];
+            }
+        }
+        Slot* slot = freeList;
+        freeList = slot->next;
+        numCreated++;
+        return slot;
+    }
+
+    public:
+        OrganismPool() {;}
+        OrganismPool(const OrganismPool &) = delete;
+        OrganismPool &operator=(const OrganismPool &) = delete;
+
+
+        /**
+         * Constructs an organism in a pooled slot.
+         * @param args Arguments forwarded to the organism's constructor.
+         * @return Pointer to the new organism.
+         */
+        template <typename T, typename... ARGS>
+        T* New(ARGS &&... args) {
+            static_assert(sizeof(T) <= SLOT_SIZE, "organism type is too large for OrganismPool slots");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "organism type is over-aligned for OrganismPool slots");
+            return new (Allocate()) T(std::forward<ARGS>(args)...);
+        }
+
+
+        /**
+         * Destroys an organism created by New and returns its slot to the free list.
+         * @param org The organism to destroy.
+         */
+        template <typename T>
+        void Delete(T* org) {
+            org->~T();
+            Slot* slot = reinterpret_cast<Slot*>(org);
+            slot->next = freeList;
+            freeList = slot;
+        }
+
+
+        size_t GetNumCreated() const {return numCreated;}
+        size_t GetNumHeapAllocations() const {return slabs.size();}
+
+        /**
+         * @return The number of organisms created without a heap allocation of their own.
+         */
+        size_t GetAllocationsAvoided() const {return numCreated - slabs.size();}
+};
+#endif
@@ -0,0 +1,121 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include "Species.h"
+
+
+/**
+ * Settings that differ between species.
+ */
+struct SpeciesParams {
+    double reproductionThreshold; // points needed to reproduce, which reproducing spends
+    double mutationSigma;         // standard deviation of an offspring's strength mutation
+    double initialStrength;       // strength of the organisms a new world is seeded with
+    size_t initialCount;          // number of organisms a new world is seeded with
+};
+
+
+/**
+ * @return Each species' defaults, as declared in its SpeciesTraits.
+ */
+template <size_t... S>
+constexpr std::array<SpeciesParams, NUM_SPECIES> DefaultSpeciesParams(std::index_sequence<S...>) {
+    return {{{SpeciesTraits<(Species) S>::reproductionThreshold, SpeciesTraits<(Species) S>::mutationSigma,
+              SpeciesTraits<(Species) S>::initialStrength, SpeciesTraits<(Species) S>::initialCount}...}};
+}
+
+
+/**
+ * The ecological constants of the model. The defaults are the model's original values, so a world built with
+ * default parameters runs exactly as before they could be changed.
+ */
+struct EcologyParams {
+    std::array<SpeciesParams, NUM_SPECIES> species = DefaultSpeciesParams(std::make_index_sequence<NUM_SPECIES>{});
+    double pointsPerUpdate = 100.0; // reproduction points every organism gains each update
+    double fightBonus = 0.05;       // fraction of the loser's strength the winner of a fight gains
+    double deathThreshold = 50.0;   // organisms weaker than this die
+    double starvationLoss = 0.01;   // fraction of strength a predator loses in an update without a kill
+    size_t huntProbes = 4;          // nearby cells a predator checks for prey each update
+
+    SpeciesParams &Of(Species s) {return species[(size_t) s];}
+    const SpeciesParams &Of(Species s) const {return species[(size_t) s];}
+
+
+    /**
+     * Finds a parameter by name. Shared parameters use their own names (points_per_update, fight_bonus,
+     * death_threshold, starvation_loss, hunt_probes); per-species ones are prefixed with the species, as in
+     * predator.reproduction_threshold, prey.mutation_sigma, org.initial_strength, or prey.initial_count.
+     * @param name The parameter's name.
+     * @param value Set to the parameter's current value.
+     * @return false if there is no parameter with that name.
+     */
+    bool Get(const std::string &name, double &value) const {
+        return const_cast<EcologyParams*>(this)->Access(name, value, false);
+    }
+
+
+    /**
+     * Changes a parameter by name (see Get for the names). Counts are truncated to whole numbers.
+     * @param name The parameter's name.
+     * @param value The new value.
+     * @return false if there is no parameter with that name.
+     */
+    bool Set(const std::string &name, double value) {
+        return Access(name, value, true);
+    }
+
+
+    /**
+     * Parses a NAME=VALUE assignment and applies it.
+     * @param assignment The assignment.
+     * @return false if the assignment is malformed or names no parameter.
+     */
+    bool Parse(const std::string &assignment) {
+        size_t equals = assignment.find('=');
+        if (equals == std::string::npos) {return false;}
+        char* end = nullptr;
+        std::string valueText = assignment.substr(equals + 1);
+        double value = std::strtod(valueText.c_str(), &end);
+        if (valueText.empty() || *end != '\0') {return false;}
+        return Set(assignment.substr(0, equals), value);
+    }
+
+    private:
+
+        /**
+         * Reads or writes the named parameter.
+         */
+        bool Access(const std::string &name, double &value, bool write) {
+            auto access = [&](double &field) { if (write) {field = value;} else {value = field;} return true; };
+            auto accessCount = [&](size_t &field) {
+                if (write) {field = value > 0.0 ? (size_t) value : 0;} else {value = (double) field;}
+                return true;
+            };
+
+            if (name == "points_per_update") {return access(pointsPerUpdate);}
+            if (name == "fight_bonus") {return access(fightBonus);}
+            if (name == "death_threshold") {return access(deathThreshold);}
+            if (name == "starvation_loss") {return access(starvationLoss);}
+            if (name == "hunt_probes") {return accessCount(huntProbes);}
+
+            for (size_t s = 0; s < NUM_SPECIES; s++) {
+                std::string prefix = SpeciesName((Species) s);
+                for (char &c : prefix) {c = (char) std::tolower((unsigned char) c);}
+                prefix += ".";
+                if (name.compare(0, prefix.size(), prefix) != 0) {continue;}
+                std::string field = name.substr(prefix.size());
+                if (field == "reproduction_threshold") {return access(species[s].reproductionThreshold);}
+                if (field == "mutation_sigma") {return access(species[s].mutationSigma);}
+                if (field == "initial_strength") {return access(species[s].initialStrength);}
+                if (field == "initial_count") {return accessCount(species[s].initialCount);}
+            }
+            return false;
+        }
+};
+#endif
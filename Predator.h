@@ -9,21 +9,22 @@
 class Predator : public Organism {
 
     public:
-        Predator(emp::Ptr<emp::Random> _random, double _points=0.0, double _strength = 2000.0) : Organism(_random, _points,  _strength){;}
-        
-        std::string GetType() override {return "Predator";}
+        Predator(emp::Ptr<emp::Random> _random, double _points=0.0, double _strength = 2000.0) : Organism(_random, _points,  _strength, Species::Predator){;}
         
 
         /**
          * If a Predator can reproduce, creates its offspring.
+         * @param pool The pool the offspring is allocated from.
+         * @param params The world's ecological parameters.
          * @return Pointer to offspring (null pointer if the Predator cannot reproduce)
          */
-        emp::Ptr<Organism> CheckReproduction() override{
-            if (GetPoints()>= 1000.0) {
-                Predator* offspring = new Predator(*this);
-                offspring->mutate(*GetRandom());
+        emp::Ptr<Organism> CheckReproduction(OrganismPool &pool, const EcologyParams &params) override{
+            double threshold = params.Of(Species::Predator).reproductionThreshold;
+            if (GetPoints() >= threshold) {
+                Predator* offspring = pool.New<Predator>(*this);
+                offspring->mutate(*GetRandom(), params);
                 offspring->SetPoints(0.0);
-                AddPoints(-1000.0);
+                AddPoints(-threshold);
                 return offspring;
             }
             else {
@@ -32,24 +33,15 @@ class Predator : public Organism {
         }
 
 
-        /**
-         * Mutates a Predator's strength value by a small, pseudorandom amount
-         * @param random Pseudorandom number generator
-         */
-        virtual void mutate(emp::Random random) override {
-            double randomNum = random.GetRandNormal(0.0, 20.0);
-            AddStrength(randomNum);
-        }
-
-
         /**
          * Facilitates a hunt, updating predator's and prey's strength levels and death status accordingly.
          * @param prey The organism that is being hunted.
          * @param predatorPosition The predator's position in the population.
          * @param preyPosition The prey's position in the population.
+         * @param params The world's ecological parameters.
          * @return position of the organism that will die.
          */
-        int Hunt(Organism* prey, int predatorPosition, int preyPosition) {
+        int Hunt(Organism* prey, int predatorPosition, int preyPosition, const EcologyParams &params) {
             double predatorStrength = GetStrength();
             double preyStrength = prey->GetStrength();
             // if predator is stronger, it kills and eats the prey, gaining its strength points
@@ -59,7 +51,7 @@ class Predator : public Organism {
             }
             // if the prey is stronger, it kills the predator
             else {
-                prey->AddStrength(0.05 * predatorStrength);
+                prey->AddStrength(params.fightBonus * predatorStrength);
                 return predatorPosition;
             }
         }
@@ -70,18 +62,22 @@ class Predator : public Organism {
          * @param org2 The second organism in the interaction.
          * @param org1Position The first organism's position in the population.
          * @param org2Position The second organism's position in the population.
+         * @param params The world's ecological parameters.
          * @return position of the organism that will die.
          */
-        virtual int Interact(Organism* org2, int org1Position, int org2Position) override {
+        virtual int Interact(Organism* org2, int org1Position, int org2Position, const EcologyParams &params) override {
             int indexToDie;
-            if (org2->GetType() == "Prey") { // if the other org is prey, the predator hunts it
-                indexToDie = Hunt(org2, org1Position, org2Position);
+            if (org2->GetSpecies() == Species::Prey) { // if the other org is prey, the predator hunts it
+                indexToDie = Hunt(org2, org1Position, org2Position, params);
             }
             else { // otherwise, predator fights the other org to the death
-                indexToDie = Fight(org2, org1Position, org2Position);
+                indexToDie = Fight(org2, org1Position, org2Position, params);
             }
             return indexToDie;
         }
 
 };
-#endif
\ No newline at end of file
+
+template <>
+struct SpeciesClass<Species::Predator> {using type = Predator;};
+#endif
@@ -0,0 +1,59 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <chrono>
+#include <cstddef>
+
+
+/**
+ * The phases of OrgWorld::Update() that can be timed separately.
+ */
+enum Phase {
+    PHASE_ACCRUAL,      // points-accrual pass
+    PHASE_MOVE,         // MoveOrganism
+    PHASE_HUNT,         // ManageHuntingAtIdx
+    PHASE_DEATH,        // ManageDeathAtIdx
+    PHASE_REPRODUCTION, // ManageReproductionAtIdx
+    NUM_PHASES
+};
+
+
+/**
+ * Accumulates wall-clock time and call counts for each phase of an update, plus the number of organisms processed.
+ */
+struct PhaseProfile {
+    double seconds[NUM_PHASES] = {};
+    size_t calls[NUM_PHASES] = {};
+    size_t organismsProcessed = 0;
+
+    void Reset() {*this = PhaseProfile();}
+
+    static const char* PhaseName(int phase) {
+        static const char* names[NUM_PHASES] = {"accrual", "move", "hunt", "death", "reproduction"};
+        return names[phase];
+    }
+};
+
+
+/**
+ * Times one phase for as long as it is in scope, adding the result to a profile. Does nothing if the profile is null.
+ */
+class PhaseTimer {
+    PhaseProfile* profile;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+
+    public:
+        PhaseTimer(PhaseProfile* _profile, Phase _phase) : profile(_profile), phase(_phase) {
+            if (profile) {start = std::chrono::steady_clock::now();}
+        }
+
+        ~PhaseTimer() {
+            if (profile) {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                profile->seconds[phase] += elapsed.count();
+                profile->calls[phase]++;
+            }
+        }
+};
+#endif
@@ -0,0 +1,369 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include "emp/base/vector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include "Params.h"
+#include "Species.h"
+
+
+/**
+ * Event logs for checking that a change to the update loop leaves trajectories untouched. A world given a
+ * ReplayLog reports every move, interaction, death, and birth as it happens; a log recorded by one build can then
+ * be replayed against another (see AEReplay.cpp), which stops at the first event that differs. Because every
+ * rule draws from the one shared generator, a reordering anywhere shows up as a divergence soon after it, with the
+ * update and cell where the runs first disagreed.
+ *
+ * A log file holds, in native little-endian order, a ReplayHeader describing how the run was set up followed by
+ * ReplayHeader::numEvents ReplayEvents.
+ */
+enum class ReplayEventType : uint8_t {
+    Update,    // an update begins; from is its number
+    Move,      // the organism at from moves to to; value is its strength
+    Encounter, // the organism that moved from from fights or hunts the occupant of to; value is the mover's new strength
+    Hunt,      // the predator at from hunts the prey at to; value is the survivor's new strength
+    Starve,    // the predator at from found nothing to eat; value is its new strength
+    Death,     // the organism at from dies of weakness; value is its strength
+    Birth      // the organism at from gives birth at to; value is the offspring's strength
+};
+
+
+/**
+ * One logged event. Positions are population indices (y * width + x), whatever the world's storage.
+ */
+struct ReplayEvent {
+    uint64_t from;
+    uint64_t to;
+    double value;
+    ReplayEventType type;
+    Species species;      // the species of the organism at from
+    Species otherSpecies; // Encounter and Hunt: the species of the organism at to
+    uint8_t outcome;      // Encounter and Hunt: 1 if the organism at from won
+    uint8_t padding[4];
+
+    bool operator==(const ReplayEvent &other) const {
+        return from == other.from && to == other.to && value == other.value && type == other.type
+               && species == other.species && otherSpecies == other.otherSpecies && outcome == other.outcome;
+    }
+
+    bool operator!=(const ReplayEvent &other) const {return !(*this == other);}
+};
+
+
+/**
+ * How the logged run was set up, so that it can be run again.
+ */
+struct ReplayHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t paramsSize;
+    char engine[16];       // "org", "compact", or "chunked"
+    uint64_t width;
+    uint64_t height;
+    int64_t seed;
+    uint64_t numUpdates;
+    uint64_t numEvents;    // filled in when the log is closed
+    uint8_t occupiedOnly;  // occupied-only scheduling
+    uint8_t fastNeighbors; // CompactWorld's --neighbors sampler
+    uint8_t padding[6];
+    EcologyParams params;
+};
+
+static const char REPLAY_MAGIC[8] = {'A', 'E', 'R', 'E', 'P', 'L', 'A', 'Y'};
+static const uint32_t REPLAY_VERSION = 1;
+
+// headers and events are written byte for byte
+static_assert(std::is_trivially_copyable<EcologyParams>::value, "replay logs require a trivially copyable EcologyParams");
+static_assert(sizeof(ReplayEvent) == 32, "ReplayEvent should pack into 32 bytes");
+
+
+/**
+ * Records events to a log file, or checks events against one. Events are buffered and written or read a block at
+ * a time. When checking, the first event that differs from the log is kept, and later events are only counted.
+ */
+class ReplayLog {
+    static constexpr size_t BLOCK_EVENTS = 4096;
+
+    FILE* file = nullptr;
+    bool checking = false;
+    ReplayHeader header{};
+    emp::vector<ReplayEvent> block;
+    size_t blockPos = 0;     // next event in block
+    size_t blockSize = 0;    // events read into block, when checking
+    uint64_t numEvents = 0;  // events recorded or checked so far
+    uint64_t update = 0;     // the update the latest event belongs to
+
+    bool diverged = false;
+    uint64_t divergenceIndex = 0;
+    uint64_t divergenceUpdate = 0;
+    ReplayEvent expected{};
+    ReplayEvent actual{};
+    bool expectedPresent = false; // false if the log ended before the divergent event
+
+
+    bool WriteBlock() {
+        bool written = std::fwrite(block.data(), sizeof(ReplayEvent), blockPos, file) == blockPos;
+        blockPos = 0;
+        return written;
+    }
+
+
+    /**
+     * Reads the next logged event.
+     * @param event Set to the event.
+     * @return false if the log has no more events.
+     */
+    bool ReadEvent(ReplayEvent &event) {
+        if (blockPos == blockSize) {
+            uint64_t remaining = header.numEvents - numEvents;
+            size_t wanted = (size_t) std::min<uint64_t>(BLOCK_EVENTS, remaining);
+            blockSize = wanted ? std::fread(block.data(), sizeof(ReplayEvent), wanted, file) : 0;
+            blockPos = 0;
+            if (blockSize == 0) {return false;}
+        }
+        event = block[blockPos++];
+        return true;
+    }
+
+
+    void Check(const ReplayEvent &event) {
+        ReplayEvent logged;
+        bool present = ReadEvent(logged);
+        if (!present || logged != event) {
+            diverged = true;
+            divergenceIndex = numEvents;
+            divergenceUpdate = update;
+            expected = logged;
+            actual = event;
+            expectedPresent = present;
+        }
+    }
+
+    public:
+
+        ReplayLog() {;}
+
+        ~ReplayLog() {
+            if (file) {std::fclose(file);}
+        }
+
+        ReplayLog(const ReplayLog &) = delete;
+        ReplayLog &operator=(const ReplayLog &) = delete;
+
+
+        /**
+         * Makes a header for a run, leaving the grid size, seed, update count, and scheduling for the caller to fill in.
+         * @param engine The world type, "org", "compact", or "chunked".
+         * @param params The run's ecological parameters.
+         * @return The header.
+         */
+        static ReplayHeader MakeHeader(const std::string &engine, const EcologyParams &params) {
+            ReplayHeader made{};
+            std::memcpy(made.magic, REPLAY_MAGIC, sizeof(made.magic));
+            made.version = REPLAY_VERSION;
+            made.paramsSize = sizeof(EcologyParams);
+            std::strncpy(made.engine, engine.c_str(), sizeof(made.engine) - 1);
+            made.params = params;
+            return made;
+        }
+
+
+        /**
+         * Starts recording a new log.
+         * @param path Where to write the log.
+         * @param _header The run's setup.
+         * @param error Set to a description of the problem if the log cannot be created.
+         * @return true if the log was created.
+         */
+        bool Create(const std::string &path, const ReplayHeader &_header, std::string &error) {
+            file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                error = "cannot open " + path + " for writing";
+                return false;
+            }
+            header = _header;
+            header.numEvents = 0;
+            checking = false;
+            block.resize(BLOCK_EVENTS);
+            if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+                error = "failed writing " + path;
+                return false;
+            }
+            return true;
+        }
+
+
+        /**
+         * Opens a recorded log to check a run against.
+         * @param path The log to read.
+         * @param error Set to a description of the problem if the log cannot be read.
+         * @return true if the log was opened.
+         */
+        bool Open(const std::string &path, std::string &error) {
+            file = std::fopen(path.c_str(), "rb");
+            if (file == nullptr) {
+                error = "cannot open " + path;
+                return false;
+            }
+            if (std::fread(&header, sizeof(header), 1, file) != 1
+                || std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0) {
+                error = path + " is not a replay log";
+                return false;
+            }
+            if (header.version != REPLAY_VERSION || header.paramsSize != sizeof(EcologyParams)) {
+                error = path + " was written by an incompatible build";
+                return false;
+            }
+            header.engine[sizeof(header.engine) - 1] = '\0';
+            checking = true;
+            block.resize(BLOCK_EVENTS);
+            return true;
+        }
+
+
+        /**
+         * @return The log's header; when recording, numEvents is only filled in by Close.
+         */
+        const ReplayHeader &GetHeader() const {return header;}
+
+
+        /**
+         * Records an event, or checks it against the log.
+         * @param event The event.
+         */
+        void Record(const ReplayEvent &event) {
+            if (event.type == ReplayEventType::Update) {update = event.from;}
+            if (checking) {
+                if (!diverged) {Check(event);}
+            }
+            else {
+                block[blockPos++] = event;
+                if (blockPos == BLOCK_EVENTS) {WriteBlock();}
+            }
+            numEvents++;
+        }
+
+
+        /**
+         * Records an event, or checks it against the log (see ReplayEvent for what each field means).
+         */
+        void Record(ReplayEventType type, Species species, uint64_t from, uint64_t to, double value,
+                    Species otherSpecies = Species::Org, bool outcome = false) {
+            ReplayEvent event{};
+            event.from = from;
+            event.to = to;
+            event.value = value;
+            event.type = type;
+            event.species = species;
+            event.otherSpecies = otherSpecies;
+            event.outcome = outcome;
+            Record(event);
+        }
+
+
+        /**
+         * Finishes the log. A recorded log has its remaining events and its event count written; a checked run
+         * that produced fewer events than the log counts as diverging where it stopped.
+         * @param error Set to a description of the problem if writing fails.
+         * @return true if the log was finished cleanly.
+         */
+        bool Close(std::string &error) {
+            if (file == nullptr) {
+                return true;
+            }
+            bool ok = true;
+            if (checking) {
+                ReplayEvent logged;
+                if (!diverged && ReadEvent(logged)) {
+                    diverged = true;
+                    divergenceIndex = numEvents;
+                    divergenceUpdate = update;
+                    expected = logged;
+                    expectedPresent = true;
+                }
+            }
+            else {
+                header.numEvents = numEvents;
+                ok = WriteBlock() && std::fseek(file, 0, SEEK_SET) == 0
+                     && std::fwrite(&header, sizeof(header), 1, file) == 1;
+                if (!ok) {error = "failed writing the replay log";}
+            }
+            if (std::fclose(file) != 0 && ok) {
+                error = "failed writing the replay log";
+                ok = false;
+            }
+            file = nullptr;
+            return ok;
+        }
+
+
+        uint64_t GetNumEvents() const {return numEvents;}
+        bool HasDiverged() const {return diverged;}
+
+        /**
+         * @return The index of the first event that differed from the log (or the first missing one).
+         */
+        uint64_t GetDivergenceIndex() const {return divergenceIndex;}
+
+        /**
+         * @return The update the first divergent event belongs to.
+         */
+        uint64_t GetDivergenceUpdate() const {return divergenceUpdate;}
+
+        /**
+         * Describes the first divergence: what the log expected and what the run did instead.
+         * @return One line each for the logged and the actual event.
+         */
+        std::string DescribeDivergence() const {
+            bool actualPresent = divergenceIndex < numEvents;
+            return "  logged: " + (expectedPresent ? Describe(expected) : std::string("(end of log)")) + "\n"
+                   + "  replay: " + (actualPresent ? Describe(actual) : std::string("(end of run)")) + "\n";
+        }
+
+
+        /**
+         * @return A readable description of an event.
+         */
+        static std::string Describe(const ReplayEvent &event) {
+            std::ostringstream text;
+            text.precision(17);
+            const char* name = SpeciesName(event.species);
+            switch (event.type) {
+                case ReplayEventType::Update:
+                    text << "update " << event.from << " begins";
+                    break;
+                case ReplayEventType::Move:
+                    text << name << " moves " << event.from << " -> " << event.to << " with strength " << event.value;
+                    break;
+                case ReplayEventType::Encounter:
+                    text << name << " from " << event.from << " meets " << SpeciesName(event.otherSpecies) << " at "
+                         << event.to << ", " << (event.outcome ? "wins" : "loses") << ", strength " << event.value;
+                    break;
+                case ReplayEventType::Hunt:
+                    text << name << " at " << event.from << " hunts " << SpeciesName(event.otherSpecies) << " at "
+                         << event.to << ", " << (event.outcome ? "kills it" : "is killed")
+                         << ", survivor strength " << event.value;
+                    break;
+                case ReplayEventType::Starve:
+                    text << name << " at " << event.from << " starves to strength " << event.value;
+                    break;
+                case ReplayEventType::Death:
+                    text << name << " at " << event.from << " dies with strength " << event.value;
+                    break;
+                case ReplayEventType::Birth:
+                    text << name << " at " << event.from << " gives birth at " << event.to << " with strength "
+                         << event.value;
+                    break;
+                default:
+                    text << "unknown event " << (int) event.type;
+            }
+            return text.str();
+        }
+};
+#endif
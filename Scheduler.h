@@ -0,0 +1,116 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "emp/base/vector.hpp"
+#include "emp/math/Random.hpp"
+#include <cstddef>
+
+
+/**
+ * Builds the random visiting order for each pass of an update in a buffer that is reused across updates.
+ * It can also keep a list of occupied cells up to date as organisms are placed and removed, so sparse worlds
+ * can shuffle just those cells instead of every cell in the grid.
+ */
+class Scheduler {
+    static constexpr size_t NOT_LISTED = (size_t) -1;
+
+    emp::vector<size_t> order;         // the schedule handed out to callers
+    emp::vector<size_t> occupiedCells; // occupied cells, in no particular order
+    emp::vector<size_t> slotOf;        // each cell's position in occupiedCells, or NOT_LISTED
+    bool tracking = false;
+
+    public:
+
+        /**
+         * Shuffles every cell index in [0, numCells). Uses the same inside-out shuffle and draws as
+         * emp::GetPermutation, so it yields the same order without allocating a new vector.
+         * @param random The generator to shuffle with.
+         * @param numCells The number of cells.
+         * @return The shuffled indices (valid until the next call).
+         */
+        const emp::vector<size_t> &Permutation(emp::Random &random, size_t numCells) {
+            order.resize(numCells);
+            if (numCells == 0) {return order;}
+            order[0] = 0;
+            for (size_t i = 1; i < numCells; i++) {
+                size_t j = random.GetUInt(i+1);
+                order[i] = order[j];
+                order[j] = i;
+            }
+            return order;
+        }
+
+
+        /**
+         * Shuffles a copy of the given cells.
+         * @param random The generator to shuffle with.
+         * @param cells The cells to shuffle.
+         * @return The shuffled cells (valid until the next call).
+         */
+        const emp::vector<size_t> &Shuffle(emp::Random &random, const emp::vector<size_t> &cells) {
+            order.resize(cells.size());
+            for (size_t i = 0; i < cells.size(); i++) {
+                size_t j = i ? random.GetUInt(i+1) : 0;
+                order[i] = order[j];
+                order[j] = cells[i];
+            }
+            return order;
+        }
+
+
+        /**
+         * Starts maintaining the list of occupied cells, seeding it from the world's current state.
+         * @param numCells The number of cells in the world.
+         * @param isOccupied Callable reporting whether a cell is occupied.
+         */
+        template <typename IS_OCCUPIED>
+        void StartTracking(size_t numCells, IS_OCCUPIED isOccupied) {
+            tracking = true;
+            occupiedCells.clear();
+            slotOf.assign(numCells, NOT_LISTED);
+            for (size_t i = 0; i < numCells; i++) {
+                if (isOccupied(i)) {OnPlace(i);}
+            }
+        }
+
+
+        /**
+         * Stops maintaining the list of occupied cells and frees it.
+         */
+        void StopTracking() {
+            tracking = false;
+            occupiedCells = emp::vector<size_t>();
+            slotOf = emp::vector<size_t>();
+        }
+
+        bool IsTracking() const {return tracking;}
+        const emp::vector<size_t> &GetOccupied() const {return occupiedCells;}
+
+
+        /**
+         * Records that a cell has become occupied (no effect if it already was, or if not tracking).
+         * @param cell The cell.
+         */
+        void OnPlace(size_t cell) {
+            if (!tracking || slotOf[cell] != NOT_LISTED) {return;}
+            slotOf[cell] = occupiedCells.size();
+            occupiedCells.push_back(cell);
+        }
+
+
+        /**
+         * Records that a cell has become empty (no effect if it already was, or if not tracking).
+         * @param cell The cell.
+         */
+        void OnRemove(size_t cell) {
+            if (!tracking || slotOf[cell] == NOT_LISTED) {return;}
+            // move the last listed cell into the vacated slot
+            size_t slot = slotOf[cell];
+            size_t last = occupiedCells.back();
+            occupiedCells[slot] = last;
+            slotOf[last] = slot;
+            occupiedCells.pop_back();
+            slotOf[cell] = NOT_LISTED;
+        }
+};
+#endif
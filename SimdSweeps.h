@@ -0,0 +1,282 @@
+#ifndef SIMD_SWEEPS_H
+#define SIMD_SWEEPS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AE_SWEEPS_X86 1
+#include <immintrin.h>
+#else
+#define AE_SWEEPS_X86 0
+#endif
+
+
+/**
+ * The whole-grid passes of CompactWorld's synchronous update, as sweeps over the per-cell arrays masked by a
+ * bitmap (one bit per cell, as CompactWorld's occupancy bitmap). Each has an AVX-512 and an AVX2 version, compiled
+ * for those instruction sets whatever the build flags and chosen at run time by what the processor supports, and a
+ * scalar version for everything else (including the WebAssembly build). The vector versions perform the same
+ * arithmetic per cell as the scalar one, so every level gives the same results.
+ *
+ * Words of the bitmap with no bits set are skipped, which keeps sparse grids cheap; within a word the sweeps don't
+ * branch on individual cells. Masked loads and stores never touch cells past the end of the arrays.
+ */
+enum SweepLevel {
+    SWEEP_SCALAR,
+    SWEEP_AVX2,
+    SWEEP_AVX512,
+};
+
+
+class Sweeps {
+
+    static void AccruePointsScalar(double* points, const uint64_t* mask, size_t numWords, double amount) {
+        for (size_t word = 0; word < numWords; word++) {
+            for (uint64_t bits = mask[word]; bits; bits &= bits - 1) {
+                points[word * 64 + __builtin_ctzll(bits)] += amount;
+            }
+        }
+    }
+
+    static void StarveScalar(double* strength, const uint64_t* mask, size_t numWords, double loss) {
+        for (size_t word = 0; word < numWords; word++) {
+            for (uint64_t bits = mask[word]; bits; bits &= bits - 1) {
+                double &value = strength[word * 64 + __builtin_ctzll(bits)];
+                value -= loss * value;
+            }
+        }
+    }
+
+    static size_t RemoveWeakScalar(const double* strength, uint64_t* mask, size_t numWords, double threshold) {
+        size_t removed = 0;
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t weak = 0;
+            for (uint64_t bits = mask[word]; bits; bits &= bits - 1) {
+                size_t bit = __builtin_ctzll(bits);
+                weak |= (uint64_t) (strength[word * 64 + bit] < threshold) << bit;
+            }
+            mask[word] &= ~weak;
+            removed += __builtin_popcountll(weak);
+        }
+        return removed;
+    }
+
+#if AE_SWEEPS_X86
+    // AVX2: four cells at a time, with each lane's bit of the word expanded into a full-width lane mask
+
+    __attribute__((target("avx2")))
+    static __m256i LaneMask4(uint64_t bits) {
+        const __m256i lanes = _mm256_set_epi64x(8, 4, 2, 1);
+        return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x((long long) bits), lanes), lanes);
+    }
+
+    __attribute__((target("avx2")))
+    static void AccruePointsAvx2(double* points, const uint64_t* mask, size_t numWords, double amount) {
+        const __m256d addend = _mm256_set1_pd(amount);
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t bits = mask[word];
+            if (bits == 0) {continue;}
+            double* cells = points + word * 64;
+            for (size_t k = 0; k < 64; k += 4) {
+                __m256i lanes = LaneMask4(bits >> k);
+                __m256d value = _mm256_maskload_pd(cells + k, lanes);
+                _mm256_maskstore_pd(cells + k, lanes, _mm256_add_pd(value, addend));
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    static void StarveAvx2(double* strength, const uint64_t* mask, size_t numWords, double loss) {
+        const __m256d factor = _mm256_set1_pd(loss);
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t bits = mask[word];
+            if (bits == 0) {continue;}
+            double* cells = strength + word * 64;
+            for (size_t k = 0; k < 64; k += 4) {
+                __m256i lanes = LaneMask4(bits >> k);
+                __m256d value = _mm256_maskload_pd(cells + k, lanes);
+                _mm256_maskstore_pd(cells + k, lanes, _mm256_sub_pd(value, _mm256_mul_pd(factor, value)));
+            }
+        }
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    static size_t RemoveWeakAvx2(const double* strength, uint64_t* mask, size_t numWords, double threshold) {
+        const __m256d limit = _mm256_set1_pd(threshold);
+        size_t removed = 0;
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t bits = mask[word];
+            if (bits == 0) {continue;}
+            const double* cells = strength + word * 64;
+            uint64_t weak = 0;
+            for (size_t k = 0; k < 64; k += 4) {
+                __m256d value = _mm256_maskload_pd(cells + k, LaneMask4(bits >> k));
+                weak |= (uint64_t) _mm256_movemask_pd(_mm256_cmp_pd(value, limit, _CMP_LT_OQ)) << k;
+            }
+            weak &= bits; // empty lanes loaded as 0.0
+            mask[word] = bits & ~weak;
+            removed += __builtin_popcountll(weak);
+        }
+        return removed;
+    }
+
+
+    // AVX-512: eight cells at a time, with each byte of the word used directly as a lane mask
+
+    __attribute__((target("avx512f")))
+    static void AccruePointsAvx512(double* points, const uint64_t* mask, size_t numWords, double amount) {
+        const __m512d addend = _mm512_set1_pd(amount);
+        const __m512d zero = _mm512_setzero_pd();
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t bits = mask[word];
+            if (bits == 0) {continue;}
+            double* cells = points + word * 64;
+            for (size_t k = 0; k < 64; k += 8) {
+                __mmask8 lanes = (__mmask8) (bits >> k);
+                __m512d value = _mm512_mask_loadu_pd(zero, lanes, cells + k);
+                _mm512_mask_storeu_pd(cells + k, lanes, _mm512_add_pd(value, addend));
+            }
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    static void StarveAvx512(double* strength, const uint64_t* mask, size_t numWords, double loss) {
+        const __m512d factor = _mm512_set1_pd(loss);
+        const __m512d zero = _mm512_setzero_pd();
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t bits = mask[word];
+            if (bits == 0) {continue;}
+            double* cells = strength + word * 64;
+            for (size_t k = 0; k < 64; k += 8) {
+                __mmask8 lanes = (__mmask8) (bits >> k);
+                __m512d value = _mm512_mask_loadu_pd(zero, lanes, cells + k);
+                // an explicitly rounded multiply, which the compiler can't fuse with the subtraction (AVX-512
+                // implies FMA), so the loss is rounded before it is taken, as in the other versions; the zero-masked
+                // form (all lanes on) gives the same result without the unmasked form's uninitialized pass-through
+                __m512d lost = _mm512_maskz_mul_round_pd((__mmask8) 0xff, factor, value,
+                                                         _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                _mm512_mask_storeu_pd(cells + k, lanes, _mm512_sub_pd(value, lost));
+            }
+        }
+    }
+
+    __attribute__((target("avx512f,popcnt")))
+    static size_t RemoveWeakAvx512(const double* strength, uint64_t* mask, size_t numWords, double threshold) {
+        const __m512d limit = _mm512_set1_pd(threshold);
+        const __m512d zero = _mm512_setzero_pd();
+        size_t removed = 0;
+        for (size_t word = 0; word < numWords; word++) {
+            uint64_t bits = mask[word];
+            if (bits == 0) {continue;}
+            const double* cells = strength + word * 64;
+            uint64_t weak = 0;
+            for (size_t k = 0; k < 64; k += 8) {
+                __mmask8 lanes = (__mmask8) (bits >> k);
+                __m512d value = _mm512_mask_loadu_pd(zero, lanes, cells + k);
+                weak |= (uint64_t) _mm512_mask_cmp_pd_mask(lanes, value, limit, _CMP_LT_OQ) << k;
+            }
+            mask[word] = bits & ~weak;
+            removed += __builtin_popcountll(weak);
+        }
+        return removed;
+    }
+#endif
+
+
+    static SweepLevel Supported() {
+#if AE_SWEEPS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {return SWEEP_AVX512;}
+        if (__builtin_cpu_supports("avx2")) {return SWEEP_AVX2;}
+#endif
+        return SWEEP_SCALAR;
+    }
+
+
+    static SweepLevel &CurrentLevel() {
+        static SweepLevel level = Supported();
+        return level;
+    }
+
+    public:
+
+        /**
+         * @return The widest instruction set the processor supports.
+         */
+        static SweepLevel GetSupportedLevel() {
+            static const SweepLevel supported = Supported();
+            return supported;
+        }
+
+        /**
+         * @return The instruction set the sweeps use, which starts as the widest supported.
+         */
+        static SweepLevel GetLevel() {return CurrentLevel();}
+
+        /**
+         * Limits the sweeps to the given instruction set (or the widest supported one, if that is narrower), for
+         * example to benchmark or check the scalar versions on a processor with vector units.
+         * @param level The instruction set to use.
+         * @return The instruction set now in use.
+         */
+        static SweepLevel SetLevel(SweepLevel level) {
+            CurrentLevel() = level < GetSupportedLevel() ? level : GetSupportedLevel();
+            return CurrentLevel();
+        }
+
+        static const char* LevelName(SweepLevel level) {
+            static const char* names[] = {"scalar", "avx2", "avx512"};
+            return names[level];
+        }
+
+
+        /**
+         * Adds an amount to every cell set in the mask.
+         * @param points The per-cell values.
+         * @param mask One bit per cell.
+         * @param numWords The number of 64-bit words in the mask.
+         * @param amount The amount to add.
+         */
+        static void AccruePoints(double* points, const uint64_t* mask, size_t numWords, double amount) {
+#if AE_SWEEPS_X86
+            if (CurrentLevel() == SWEEP_AVX512) {return AccruePointsAvx512(points, mask, numWords, amount);}
+            if (CurrentLevel() == SWEEP_AVX2) {return AccruePointsAvx2(points, mask, numWords, amount);}
+#endif
+            AccruePointsScalar(points, mask, numWords, amount);
+        }
+
+
+        /**
+         * Takes a fraction of its strength from every cell set in the mask (value -= loss * value).
+         * @param strength The per-cell strengths.
+         * @param mask One bit per cell.
+         * @param numWords The number of 64-bit words in the mask.
+         * @param loss The fraction to take.
+         */
+        static void Starve(double* strength, const uint64_t* mask, size_t numWords, double loss) {
+#if AE_SWEEPS_X86
+            if (CurrentLevel() == SWEEP_AVX512) {return StarveAvx512(strength, mask, numWords, loss);}
+            if (CurrentLevel() == SWEEP_AVX2) {return StarveAvx2(strength, mask, numWords, loss);}
+#endif
+            StarveScalar(strength, mask, numWords, loss);
+        }
+
+
+        /**
+         * Clears the mask bit of every cell whose strength is below the threshold.
+         * @param strength The per-cell strengths.
+         * @param mask One bit per cell, updated in place.
+         * @param numWords The number of 64-bit words in the mask.
+         * @param threshold The strength below which a cell is cleared.
+         * @return The number of bits cleared.
+         */
+        static size_t RemoveWeak(const double* strength, uint64_t* mask, size_t numWords, double threshold) {
+#if AE_SWEEPS_X86
+            if (CurrentLevel() == SWEEP_AVX512) {return RemoveWeakAvx512(strength, mask, numWords, threshold);}
+            if (CurrentLevel() == SWEEP_AVX2) {return RemoveWeakAvx2(strength, mask, numWords, threshold);}
+#endif
+            return RemoveWeakScalar(strength, mask, numWords, threshold);
+        }
+};
+#endif
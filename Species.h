@@ -0,0 +1,114 @@
+#ifndef SPECIES_H
+#define SPECIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+
+/**
+ * Compact species identifier stored in every Organism, so a species check is a single byte comparison.
+ */
+enum class Species : uint8_t {Org, Predator, Prey};
+constexpr size_t NUM_SPECIES = 3;
+
+
+/**
+ * Compile-time description of a species: how it behaves in encounters and the default values of its parameters
+ * (which EcologyParams starts from and can change at run time). Adding a species means adding it to the enum,
+ * bumping NUM_SPECIES, and specializing this template; the kernels in SpeciesKernels.h pick it up from there.
+ */
+template <Species S> struct SpeciesTraits;
+
+template <> struct SpeciesTraits<Species::Org> {
+    static constexpr const char* name = "Org";
+    static constexpr bool hunts = false;    // hunts prey it meets, and eats them whole
+    static constexpr bool isHunted = false; // is hunted by species that hunt
+    static constexpr double reproductionThreshold = 1000.0;
+    static constexpr double mutationSigma = 5.0;
+    static constexpr double initialStrength = 500.0;
+    static constexpr size_t initialCount = 0;
+};
+
+template <> struct SpeciesTraits<Species::Predator> {
+    static constexpr const char* name = "Predator";
+    static constexpr bool hunts = true;
+    static constexpr bool isHunted = false;
+    static constexpr double reproductionThreshold = 1000.0;
+    static constexpr double mutationSigma = 20.0;
+    static constexpr double initialStrength = 2000.0;
+    static constexpr size_t initialCount = 10;
+};
+
+template <> struct SpeciesTraits<Species::Prey> {
+    static constexpr const char* name = "Prey";
+    static constexpr bool hunts = false;
+    static constexpr bool isHunted = true;
+    static constexpr double reproductionThreshold = 500.0;
+    static constexpr double mutationSigma = 1.0;
+    static constexpr double initialStrength = 100.0;
+    static constexpr size_t initialCount = 20;
+};
+
+
+/**
+ * Whether an encounter between the two species is a hunt by the first, rather than a fight.
+ */
+template <Species HUNTER, Species HUNTED>
+constexpr bool IS_HUNT = SpeciesTraits<HUNTER>::hunts && SpeciesTraits<HUNTED>::isHunted;
+
+
+template <typename FN, size_t... I>
+inline void DispatchSpeciesImpl(Species species, FN &fn, std::index_sequence<I...>) {
+    ((species == (Species) I ? (fn(std::integral_constant<Species, (Species) I>{}), true) : false) || ...);
+}
+
+
+/**
+ * Calls fn with the species as a compile-time constant, so fn can be instantiated (and inlined) once per species.
+ * Inside fn, decltype(tag)::value is the species.
+ * @param species The species.
+ * @param fn A generic callable taking a std::integral_constant<Species, S>.
+ */
+template <typename FN>
+inline void DispatchSpecies(Species species, FN &&fn) {
+    DispatchSpeciesImpl(species, fn, std::make_index_sequence<NUM_SPECIES>{});
+}
+
+
+/**
+ * Gets the display name of a species.
+ * @param species The species.
+ * @return The species' name.
+ */
+inline const char* SpeciesName(Species species) {
+    const char* name = "Org";
+    DispatchSpecies(species, [&](auto tag) { name = SpeciesTraits<decltype(tag)::value>::name; });
+    return name;
+}
+
+
+/**
+ * @return Whether the species hunts the prey it meets.
+ */
+inline bool SpeciesHunts(Species species) {
+    bool hunts = false;
+    DispatchSpecies(species, [&](auto tag) { hunts = SpeciesTraits<decltype(tag)::value>::hunts; });
+    return hunts;
+}
+
+
+/**
+ * @return Whether an encounter between the two species is a hunt by the first.
+ */
+inline bool IsHunt(Species hunter, Species hunted) {
+    bool isHunt = false;
+    DispatchSpecies(hunter, [&](auto hunterTag) {
+        DispatchSpecies(hunted, [&](auto huntedTag) {
+            isHunt = IS_HUNT<decltype(hunterTag)::value, decltype(huntedTag)::value>;
+        });
+    });
+    return isHunt;
+}
+#endif
@@ -0,0 +1,119 @@
+#ifndef SPECIES_KERNELS_H
+#define SPECIES_KERNELS_H
+
+#include "emp/math/Random.hpp"
+#include "Org.h"
+#include "OrganismPool.h"
+#include "Params.h"
+#include "Predator.h"
+#include "Prey.h"
+#include "Species.h"
+
+
+/**
+ * Species-specialized versions of the per-organism rules, instantiated once per species (or pair of species) and
+ * resolved at compile time, so the update loop can inline them instead of calling through Organism's vtable.
+ * They give exactly the results of the virtual methods, which OrgWorld keeps for validation.
+ */
+
+
+/**
+ * The result of an encounter between two organisms: which one survives and how much strength each gains.
+ */
+struct EncounterOutcome {
+    bool firstSurvives;
+    double firstGain;
+    double secondGain;
+};
+
+
+/**
+ * Resolves an encounter as Organism::Interact and its overrides do: a hunter meeting a hunted species hunts it
+ * (winning it eats the prey whole, losing it feeds the prey the fight bonus), and any other pair fights for the
+ * fight bonus. Ties go to the hunter, or in a fight to the first organism.
+ * @param firstStrength The first organism's strength.
+ * @param secondStrength The second organism's strength.
+ * @param params The world's ecological parameters.
+ * @return The outcome.
+ */
+template <Species FIRST, Species SECOND>
+inline EncounterOutcome Encounter(double firstStrength, double secondStrength, const EcologyParams &params) {
+    if constexpr (IS_HUNT<FIRST, SECOND>) {
+        if (firstStrength >= secondStrength) {return {true, secondStrength, 0.0};}
+        return {false, 0.0, params.fightBonus * firstStrength};
+    }
+    else if constexpr (IS_HUNT<SECOND, FIRST>) {
+        if (secondStrength >= firstStrength) {return {false, 0.0, firstStrength};}
+        return {true, params.fightBonus * secondStrength, 0.0};
+    }
+    else {
+        if (firstStrength >= secondStrength) {return {true, params.fightBonus * secondStrength, 0.0};}
+        return {false, 0.0, params.fightBonus * firstStrength};
+    }
+}
+
+
+/**
+ * Resolves an encounter between two organisms whose species are only known at run time.
+ */
+inline EncounterOutcome Encounter(Species first, double firstStrength, Species second, double secondStrength,
+                                  const EcologyParams &params) {
+    EncounterOutcome outcome{true, 0.0, 0.0};
+    DispatchSpecies(first, [&](auto firstTag) {
+        DispatchSpecies(second, [&](auto secondTag) {
+            outcome = Encounter<decltype(firstTag)::value, decltype(secondTag)::value>(firstStrength, secondStrength,
+                                                                                        params);
+        });
+    });
+    return outcome;
+}
+
+
+/**
+ * Gives an organism its species' strength mutation, as Organism::mutate does.
+ * @param org The organism.
+ * @param random The generator to draw from.
+ * @param params The world's ecological parameters.
+ */
+template <Species S>
+inline void Mutate(Organism &org, emp::Random &random, const EcologyParams &params) {
+    org.AddStrength(random.GetRandNormal(0.0, params.Of(S).mutationSigma));
+}
+
+
+/**
+ * Creates an organism's offspring if it has enough points, as Organism::CheckReproduction and its overrides do.
+ * @param org The organism, whose class must be SpeciesClass<S>::type.
+ * @param pool The pool the offspring is allocated from.
+ * @param random The generator to draw the offspring's mutation from.
+ * @param params The world's ecological parameters.
+ * @return The offspring, or null if the organism cannot reproduce.
+ */
+template <Species S>
+inline emp::Ptr<Organism> Reproduce(Organism &org, OrganismPool &pool, emp::Random &random,
+                                    const EcologyParams &params) {
+    using OrgType = typename SpeciesClass<S>::type;
+    double threshold = params.Of(S).reproductionThreshold;
+    if (org.GetPoints() < threshold) {
+        return nullptr;
+    }
+    OrgType* offspring = pool.New<OrgType>(static_cast<OrgType &>(org));
+    Mutate<S>(*offspring, random, params);
+    offspring->SetPoints(0.0);
+    org.AddPoints(-threshold);
+    return offspring;
+}
+
+
+/**
+ * Creates an organism's offspring (see above) for an organism whose species is only known at run time.
+ */
+inline emp::Ptr<Organism> Reproduce(Organism &org, OrganismPool &pool, emp::Random &random,
+                                    const EcologyParams &params) {
+    emp::Ptr<Organism> offspring = nullptr;
+    DispatchSpecies(org.GetSpecies(), [&](auto tag) {
+        offspring = Reproduce<decltype(tag)::value>(org, pool, random, params);
+    });
+    return offspring;
+}
+#endif
@@ -0,0 +1,142 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "emp/base/vector.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Org.h"
+
+
+/**
+ * Population statistics for one update. Counts are taken at the end of the update; strength sums are taken
+ * during the points-accrual pass at its start, which already visits every organism.
+ */
+struct UpdateStats {
+    size_t update = 0;
+    size_t count[NUM_SPECIES] = {};
+    size_t strengthSamples[NUM_SPECIES] = {};
+    double strengthSum[NUM_SPECIES] = {};
+    double strengthSumSquares[NUM_SPECIES] = {};
+    size_t births = 0;
+    size_t deaths = 0;
+    size_t hunts = 0;  // predator-prey encounters, while moving or hunting
+    size_t fights = 0; // other encounters while moving
+
+    double StrengthMean(Species species) const {
+        size_t n = strengthSamples[(size_t) species];
+        return n ? strengthSum[(size_t) species] / n : 0.0;
+    }
+
+    double StrengthVariance(Species species) const {
+        size_t n = strengthSamples[(size_t) species];
+        if (n == 0) {return 0.0;}
+        double mean = StrengthMean(species);
+        return std::max(0.0, strengthSumSquares[(size_t) species] / n - mean * mean);
+    }
+};
+
+
+/**
+ * Streams UpdateStats to a CSV file. Rows are handed off in memory and formatted and written by a background
+ * thread, so recording an update costs the caller one short lock.
+ */
+class StatsWriter {
+    FILE* file = nullptr;
+    emp::vector<char> buffer = emp::vector<char>(1 << 16); // stdio buffer for the file
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    emp::vector<UpdateStats> pending;
+    bool stopping = false;
+
+
+    /**
+     * Writes one CSV row.
+     * @param stats The statistics to write.
+     */
+    void WriteRow(const UpdateStats &stats) {
+        std::fprintf(file, "%zu,%zu,%zu,%.6g,%.6g,%.6g,%.6g,%zu,%zu,%zu,%zu\n", stats.update,
+                     stats.count[(size_t) Species::Predator], stats.count[(size_t) Species::Prey],
+                     stats.StrengthMean(Species::Predator), stats.StrengthVariance(Species::Predator),
+                     stats.StrengthMean(Species::Prey), stats.StrengthVariance(Species::Prey),
+                     stats.births, stats.deaths, stats.hunts, stats.fights);
+    }
+
+
+    /**
+     * Background loop: takes whatever rows have been queued and writes them, until asked to stop.
+     */
+    void WriterLoop() {
+        emp::vector<UpdateStats> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]{ return stopping || !pending.empty(); });
+                if (pending.empty() && stopping) {return;}
+                batch.swap(pending);
+            }
+            for (const UpdateStats &stats : batch) {
+                WriteRow(stats);
+            }
+            batch.clear();
+        }
+    }
+
+    public:
+        StatsWriter() {;}
+        ~StatsWriter() {Close();}
+        StatsWriter(const StatsWriter &) = delete;
+        StatsWriter &operator=(const StatsWriter &) = delete;
+
+
+        /**
+         * Opens the output file, writes the CSV header, and starts the writer thread.
+         * @param path The file to write.
+         * @return false if the file could not be opened.
+         */
+        bool Open(const std::string &path) {
+            Close();
+            file = std::fopen(path.c_str(), "w");
+            if (file == nullptr) {return false;}
+            std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+            std::fprintf(file, "update,predators,prey,predator_strength_mean,predator_strength_var,"
+                               "prey_strength_mean,prey_strength_var,births,deaths,hunts,fights\n");
+            stopping = false;
+            writer = std::thread(&StatsWriter::WriterLoop, this);
+            return true;
+        }
+
+
+        /**
+         * Queues one update's statistics for writing.
+         * @param stats The statistics to write.
+         */
+        void Record(const UpdateStats &stats) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.push_back(stats);
+            }
+            wake.notify_one();
+        }
+
+
+        /**
+         * Writes any queued rows, stops the writer thread, and closes the file.
+         */
+        void Close() {
+            if (file == nullptr) {return;}
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            writer.join();
+            std::fclose(file);
+            file = nullptr;
+        }
+};
+#endif
@@ -0,0 +1,164 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "emp/base/vector.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+/**
+ * A fixed set of worker threads that run parallel loops. Each loop's iterations are dealt out to per-worker
+ * queues up front; a worker takes from the front of its own queue and, once that is empty, steals from the back
+ * of the other workers' queues, so uneven iterations (such as crowded and empty tiles) still balance.
+ */
+class ThreadPool {
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    emp::vector<std::thread> threads;
+    emp::vector<std::unique_ptr<WorkQueue>> queues; // one per worker, including the calling thread
+
+    std::mutex mutex;
+    std::condition_variable startLoop;
+    std::condition_variable finishLoop;
+    std::function<void(size_t, size_t)> body;
+    size_t loopNumber = 0;
+    size_t numBusy = 0;
+    bool stopping = false;
+
+
+    /**
+     * Takes the next iteration for a worker, from its own queue first and otherwise from another worker's.
+     * @param worker The worker's id.
+     * @param task Set to the iteration that was taken.
+     * @return false if every queue is empty.
+     */
+    bool NextTask(size_t worker, size_t &task) {
+        {
+            WorkQueue &own = *queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.front();
+                own.tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            WorkQueue &victim = *queues[(worker + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    /**
+     * Runs iterations of the current loop until none are left.
+     * @param worker The worker's id.
+     */
+    void Drain(size_t worker) {
+        size_t task;
+        while (NextTask(worker, task)) {
+            body(task, worker);
+        }
+    }
+
+
+    /**
+     * Main loop of a worker thread: waits for a parallel loop, helps drain it, and reports back.
+     * @param worker The worker's id.
+     */
+    void WorkerLoop(size_t worker) {
+        size_t seenLoop = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                startLoop.wait(lock, [&]{ return stopping || loopNumber != seenLoop; });
+                if (stopping) {return;}
+                seenLoop = loopNumber;
+            }
+            Drain(worker);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--numBusy == 0) {finishLoop.notify_one();}
+            }
+        }
+    }
+
+    public:
+        /**
+         * Creates a pool that runs loops on the calling thread plus numThreads - 1 workers.
+         * @param numThreads The total number of threads to use (0 means one per hardware thread).
+         */
+        ThreadPool(size_t numThreads = 0) {
+            if (numThreads == 0) {numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());}
+            for (size_t i = 0; i < numThreads; i++) {
+                queues.emplace_back(new WorkQueue);
+            }
+            for (size_t i = 1; i < numThreads; i++) {
+                threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            startLoop.notify_all();
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        size_t GetNumThreads() const {return queues.size();}
+
+
+        /**
+         * Runs fn(i, worker) for every i in [0, count) across the pool and waits for all of them to finish.
+         * Worker ids are in [0, GetNumThreads()), so callers can keep per-worker scratch space.
+         * @param count The number of iterations.
+         * @param fn The loop body.
+         */
+        void ParallelFor(size_t count, const std::function<void(size_t, size_t)> &fn) {
+            if (count == 0) {return;}
+            if (threads.empty()) {
+                for (size_t i = 0; i < count; i++) {fn(i, 0);}
+                return;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                WorkQueue &queue = *queues[i % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(i);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                body = fn;
+                numBusy = threads.size();
+                loopNumber++;
+            }
+            startLoop.notify_all();
+
+            Drain(0);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            finishLoop.wait(lock, [&]{ return numBusy == 0; });
+        }
+};
+#endif
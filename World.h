@@ -6,9 +6,18 @@
 #include "emp/math/Random.hpp"
 #include <math.h>
 #include <algorithm>
+#include "Clusters.h"
 #include "Org.h"
+#include "Params.h"
 #include "Predator.h"
 #include "Prey.h"
+#include "Instrument.h"
+#include "Lineage.h"
+#include "Profile.h"
+#include "ReplayLog.h"
+#include "Scheduler.h"
+#include "SpeciesKernels.h"
+#include "Stats.h"
 
 
 /**
@@ -17,6 +26,68 @@
 class OrgWorld : public emp::World<Organism> {
     emp::Random &random;
     emp::Ptr<emp::Random> random_ptr;
+    PhaseProfile* profile = nullptr; // optional per-phase timing, off unless SetProfile is called
+    OrganismPool pool; // backs every organism in the population
+    EcologyParams params; // the model's ecological constants
+    bool virtualDispatch = false; // use Organism's virtual methods instead of the species kernels
+    Scheduler scheduler; // reusable update schedules and, optionally, the list of occupied cells
+
+    bool trackChanges = false;        // record cells whose occupant changes, for incremental rendering
+    emp::vector<size_t> changedCells; // cells changed since ClearChangedCells
+    emp::vector<uint8_t> isChanged;   // whether each cell is already in changedCells
+
+    UpdateStats stats; // species counts are always current; event counts cover the latest update
+    StatsWriter* statsWriter = nullptr; // receives each update's stats when set
+    ReplayLog* replayLog = nullptr; // records or checks every event when set
+    Lineage* lineage = nullptr; // records every organism's ancestry when set
+    Clusters* clusters = nullptr; // follows the grid's clusters and fronts when set
+
+
+    /**
+     * Clears the per-update event counts and strength sums, keeping the species counts.
+     */
+    void ResetUpdateStats() {
+        for (size_t s = 0; s < NUM_SPECIES; s++) {
+            stats.strengthSamples[s] = 0;
+            stats.strengthSum[s] = 0.0;
+            stats.strengthSumSquares[s] = 0.0;
+        }
+        stats.births = stats.deaths = stats.hunts = stats.fights = 0;
+    }
+
+
+    /**
+     * Adds an organism's strength to its species' running sums.
+     * @param org The organism.
+     */
+    void SampleStrength(emp::Ptr<Organism> org) {
+        size_t s = (size_t) org->GetSpecies();
+        double strength = org->GetStrength();
+        stats.strengthSamples[s]++;
+        stats.strengthSum[s] += strength;
+        stats.strengthSumSquares[s] += strength * strength;
+    }
+
+
+    /**
+     * Gives an organism placed without a parent (when seeding or restoring) its own root in the lineage, if kept.
+     * @param org The organism.
+     */
+    void FoundLineage(emp::Ptr<Organism> org) {
+        if (lineage) {org->SetLineage(lineage->AddFounder(org->GetSpecies(), org->GetStrength(), GetUpdate()));}
+    }
+
+
+    /**
+     * Records that the organism in a cell was placed, removed, or replaced.
+     * @param i The cell's position in the population.
+     */
+    void MarkChanged(size_t i) {
+        if (trackChanges && !isChanged[i]) {
+            isChanged[i] = 1;
+            changedCells.push_back(i);
+        }
+    }
 
     public:
 
@@ -25,9 +96,260 @@ class OrgWorld : public emp::World<Organism> {
     }
 
     ~OrgWorld() {
+        // organisms live in the pool, so they are released here rather than deleted by emp::World
+        lineage = nullptr; // the lineage and cluster tracker may already be gone
+        clusters = nullptr;
+        for (size_t i = 0; i < pop.size(); i++) {
+            DoDeath(i);
+        }
+        random_ptr.Delete();
+    }
+
+
+    /**
+     * @return The pool that organisms in this world are allocated from.
+     */
+    const OrganismPool &GetPool() const {return pool;}
+
+
+    /**
+     * Removes the organism at the given position (if any) and returns its memory to the pool.
+     * @param pos The organism's position in the population.
+     */
+    void DoDeath(emp::WorldPosition pos) {
+        size_t i = pos.GetIndex();
+        if (pop[i]) {
+            stats.count[(size_t) pop[i]->GetSpecies()]--;
+            stats.deaths++;
+            if (lineage) {lineage->Remove(pop[i]->GetLineage());}
+            if (clusters) {clusters->Remove(i);}
+            pool.Delete(pop[i].Raw());
+            pop[i] = nullptr;
+            scheduler.OnRemove(i);
+            MarkChanged(i);
+        }
+    }
+
+
+    /**
+     * Places a pooled organism at the given position, releasing any organism already there.
+     * @param org The organism, allocated from this world's pool.
+     * @param pos The position in the population.
+     */
+    void AddOrgAt(emp::Ptr<Organism> org, emp::WorldPosition pos) {
+        DoDeath(pos);
+        emp::World<Organism>::AddOrgAt(org, pos);
+        stats.count[(size_t) org->GetSpecies()]++;
+        if (clusters) {clusters->Place(pos.GetIndex(), org->GetSpecies());}
+        scheduler.OnPlace(pos.GetIndex());
+        MarkChanged(pos.GetIndex());
+    }
+
+
+    /**
+     * Sizes the world as a toroidal grid and seeds it with predators and prey at random locations.
+     * @param width The number of grid cells in each row.
+     * @param height The number of grid cells in each column.
+     * @param numPredators The number of predators to add.
+     * @param numPrey The number of prey to add.
+     */
+    void Initialize(size_t width, size_t height, size_t numPredators, size_t numPrey) {
+        Resize(width, height);
+        SetPopStruct_Grid(width, height);
+        if (scheduler.IsTracking()) {SetOccupiedOnlyScheduling(true);}
+        if (trackChanges) {SetChangeTracking(true);}
+        if (clusters) {clusters->Resize(width, height);}
+
+        // add predators and prey to random locations in the population
+        for (size_t i = 0; i < numPredators; i++) {
+            Predator* newPredator = pool.New<Predator>(&random, 0.0, params.Of(Species::Predator).initialStrength);
+            newPredator->mutate(random, params);
+            FoundLineage(newPredator);
+            AddOrgAt(newPredator, random.GetUInt((width * height)-1));
+        }
+        for (size_t i = 0; i < numPrey; i++) {
+            Prey* newPrey = pool.New<Prey>(&random, 0.0, params.Of(Species::Prey).initialStrength);
+            newPrey->mutate(random, params);
+            FoundLineage(newPrey);
+            AddOrgAt(newPrey, random.GetUInt((width * height)-1));
+        }
+    }
+
+
+    /**
+     * Sizes the world as a toroidal grid and seeds it with the numbers of predators and prey set in its parameters.
+     * @param width The number of grid cells in each row.
+     * @param height The number of grid cells in each column.
+     */
+    void Initialize(size_t width, size_t height) {
+        Initialize(width, height, params.Of(Species::Predator).initialCount, params.Of(Species::Prey).initialCount);
     }
 
 
+    const EcologyParams &GetParams() const {return params;}
+
+
+    /**
+     * Replaces the world's ecological parameters. Organisms already in the world keep their strength and points.
+     * @param _params The new parameters.
+     */
+    void SetParams(const EcologyParams &_params) {params = _params;}
+
+
+    /**
+     * Replaces the world's grid and organisms with the given per-cell state (as stored in a checkpoint).
+     * @param width The number of grid cells in each row.
+     * @param height The number of grid cells in each column.
+     * @param _update The update number to resume from.
+     * @param cells For each cell, 0 if empty or 1 + the occupant's Species.
+     * @param cellPoints Each occupant's reproduction points.
+     * @param cellStrength Each occupant's strength.
+     */
+    void Restore(size_t width, size_t height, size_t _update, const uint8_t* cells, const double* cellPoints,
+                 const double* cellStrength) {
+        for (size_t i = 0; i < pop.size(); i++) {
+            DoDeath(i);
+        }
+        Resize(width, height);
+        SetPopStruct_Grid(width, height);
+        update = _update;
+        if (scheduler.IsTracking()) {SetOccupiedOnlyScheduling(true);}
+        if (trackChanges) {SetChangeTracking(true);}
+        if (clusters) {clusters->Resize(width, height);}
+
+        for (size_t i = 0; i < width * height; i++) {
+            if (cells[i] == 0) {continue;}
+            Species species = (Species) (cells[i] - 1);
+            emp::Ptr<Organism> org;
+            DispatchSpecies(species, [&](auto tag) {
+                using OrgType = typename SpeciesClass<decltype(tag)::value>::type;
+                org = pool.New<OrgType>(&random, cellPoints[i], cellStrength[i]);
+            });
+            FoundLineage(org); // checkpoints don't store ancestry
+            AddOrgAt(org, i);
+        }
+        ResetUpdateStats(); // rebuilding the grid is not part of any update
+    }
+
+
+    Species GetSpeciesAt(size_t i) {return pop[i]->GetSpecies();}
+    double GetPointsAt(size_t i) {return pop[i]->GetPoints();}
+    double GetStrengthAt(size_t i) {return pop[i]->GetStrength();}
+
+
+    /**
+     * Chooses how organisms interact and reproduce: through the species kernels, which are resolved at compile
+     * time and inlined (the default), or through Organism's virtual methods. Both give identical runs, so the
+     * virtual path is kept to validate the kernels against.
+     * @param on true to use the virtual methods.
+     */
+    void SetVirtualDispatch(bool on) {virtualDispatch = on;}
+
+
+    /**
+     * Turns on per-phase timing of Update(), accumulating into the given profile (or turns it off if null).
+     * @param _profile The profile to accumulate into.
+     */
+    void SetProfile(PhaseProfile* _profile) {profile = _profile;}
+
+
+    /**
+     * Chooses between shuffling every cell in the grid each pass (the default) and shuffling only the cells that
+     * are occupied when the pass starts, from a list kept up to date as organisms are placed and removed. The
+     * occupied-only schedule gives each organism present at the start of a pass one turn, whereas the full
+     * schedule can give an organism that moves into a not-yet-visited cell a second turn, so the two schedules
+     * produce different (equally valid) runs.
+     * @param occupiedOnly true to schedule only occupied cells.
+     */
+    void SetOccupiedOnlyScheduling(bool occupiedOnly) {
+        if (occupiedOnly) {scheduler.StartTracking(GetSize(), [this](size_t i){ return IsOccupied(i); });}
+        else {scheduler.StopTracking();}
+    }
+
+
+    /**
+     * Turns on (or off) recording of which cells have had an organism placed, removed, or replaced, so a
+     * renderer can redraw just those cells after each update.
+     * @param on true to record changed cells.
+     */
+    void SetChangeTracking(bool on) {
+        trackChanges = on;
+        changedCells.clear();
+        isChanged.assign(on ? GetSize() : 0, 0);
+    }
+
+
+    /**
+     * @return The cells changed since the last call to ClearChangedCells, each listed once.
+     */
+    const emp::vector<size_t> &GetChangedCells() const {return changedCells;}
+
+
+    /**
+     * Forgets the recorded changes, typically once they have been drawn.
+     */
+    void ClearChangedCells() {
+        for (size_t i : changedCells) {
+            isChanged[i] = 0;
+        }
+        changedCells.clear();
+    }
+
+
+    /**
+     * Counts the organisms of a species currently in the world.
+     * @param species The species to count.
+     * @return The number of organisms of that species.
+     */
+    size_t CountSpecies(Species species) const {
+        return stats.count[(size_t) species];
+    }
+
+
+    /**
+     * @return true if the world has no organisms left.
+     */
+    bool IsEmpty() const {
+        return std::all_of(std::begin(stats.count), std::end(stats.count), [](size_t count) { return count == 0; });
+    }
+
+
+    /**
+     * @return Statistics for the latest update, with species counts kept current.
+     */
+    const UpdateStats &GetStats() const {return stats;}
+
+
+    /**
+     * Streams each update's statistics to the given writer (or stops streaming if null).
+     * @param _statsWriter The writer to send statistics to.
+     */
+    void SetStatsWriter(StatsWriter* _statsWriter) {statsWriter = _statsWriter;}
+
+
+    /**
+     * Reports every move, interaction, death, and birth to the given log (or stops reporting if null).
+     * @param _replayLog The log to record to or check against.
+     */
+    void SetReplayLog(ReplayLog* _replayLog) {replayLog = _replayLog;}
+
+
+    /**
+     * Records the ancestry of every organism placed from now on in the given lineage (or stops recording if null).
+     * Set it before the world is seeded, so that every organism has a node.
+     * @param _lineage The lineage to record to.
+     */
+    void SetLineage(Lineage* _lineage) {lineage = _lineage;}
+
+
+    /**
+     * Keeps the given tracker up to date with every placement and removal, and ends its update after each of the
+     * world's (or stops if null). Set it before the world is seeded or restored, which sizes it.
+     * @param _clusters The tracker.
+     */
+    void SetClusters(Clusters* _clusters) {clusters = _clusters;}
+
+
     /**
      * Removes the specified organism from the population and returns it. 
      * @param i The organism's position in the population.
@@ -35,7 +357,11 @@ class OrgWorld : public emp::World<Organism> {
      */
     emp::Ptr<Organism> ExtractOrganism(int i) {
         emp::Ptr<Organism> extractedOrganism = pop[i];
+        stats.count[(size_t) extractedOrganism->GetSpecies()]--;
+        if (clusters) {clusters->Remove(i);}
         pop[i] = nullptr;
+        scheduler.OnRemove(i);
+        MarkChanged(i);
         return extractedOrganism;
     }
 
@@ -50,9 +376,8 @@ class OrgWorld : public emp::World<Organism> {
         if (org == nullptr) {
             return nullptr;
         }
-        else if (org->GetType() == "Predator") {
-            Predator* predator = dynamic_cast<Predator*>(org);
-            return predator;
+        else if (org->GetSpecies() == Species::Predator) {
+            return static_cast<Predator*>(org);
         }
         return nullptr;
     }
@@ -61,23 +386,56 @@ class OrgWorld : public emp::World<Organism> {
     /**
      * Moves an organism to a random nearby position, resolving spatial conflicts through competition and predation. 
      * @param currentIndex The organism's current position in the population.
-     * @return The organism's new position in the population (or -infinity if the organism died).
+     * @return The organism's new position in the population (or -1 if the organism died).
      */
     int MoveOrganism(int currentIndex) {
         emp::Ptr<Organism> organismToMove = ExtractOrganism(currentIndex);
         emp::WorldPosition positionToMove = GetRandomNeighborPos(currentIndex);
         int indexToMove = positionToMove.GetIndex();
+        AE_COUNT(COUNTER_MOVES);
+        if (replayLog) {
+            replayLog->Record(ReplayEventType::Move, organismToMove->GetSpecies(), currentIndex, indexToMove,
+                              organismToMove->GetStrength());
+        }
 
         // if the position is already occupied, the organisms compete to the death over who will occupy the position next
         if (IsOccupied(positionToMove)) {
+            AE_COUNT(COUNTER_MOVES_ONTO_OCCUPIED);
             emp::Ptr<Organism> existingOrganism = ExtractOrganism(indexToMove);
-            int indexToDie = organismToMove->Interact(existingOrganism, currentIndex, indexToMove);
+            Species mover = organismToMove->GetSpecies();
+            Species occupant = existingOrganism->GetSpecies();
+            if (IsHunt(mover, occupant) || IsHunt(occupant, mover)) {
+                stats.hunts++;
+                AE_COUNT(COUNTER_ENCOUNTER_HUNTS);
+            }
+            else {
+                stats.fights++;
+                AE_COUNT(COUNTER_ENCOUNTER_FIGHTS);
+            }
+            int indexToDie;
+            if (virtualDispatch) {
+                indexToDie = organismToMove->Interact(existingOrganism, currentIndex, indexToMove, params);
+            }
+            else {
+                EncounterOutcome outcome = Encounter(mover, organismToMove->GetStrength(), occupant,
+                                                     existingOrganism->GetStrength(), params);
+                organismToMove->AddStrength(outcome.firstGain);
+                existingOrganism->AddStrength(outcome.secondGain);
+                indexToDie = outcome.firstSurvives ? indexToMove : currentIndex;
+            }
+            if (replayLog) {
+                replayLog->Record(ReplayEventType::Encounter, mover, currentIndex, indexToMove,
+                                  organismToMove->GetStrength(), occupant, indexToDie == indexToMove);
+            }
             DoDeath(indexToDie); // loser of interaction dies
+            if (lineage) {lineage->Remove(existingOrganism->GetLineage());}
+            pool.Delete(existingOrganism.Raw()); // the displaced organism is no longer in the population
+            stats.deaths++;
         }
 
         // if the organism died in the interaction, return an invalid position
         if (organismToMove == nullptr) {
-            return -INFINITY;
+            return -1;
         }
         // if the space was empty to begin with or organism won the interaction, return its new position
         else if (!IsOccupied(positionToMove)) {
@@ -98,20 +456,34 @@ class OrgWorld : public emp::World<Organism> {
         int numKills = 0;
         Predator* predator = GetPredator(predatorPosition);
 
-        for (int i=0;i<4;i++){ // predator checks 4 random nearby locations and hunts if prey is present
+        for (size_t i = 0; i < params.huntProbes; i++){ // predator checks random nearby locations and hunts if prey is present
             int randomIndex = GetRandomNeighborPos(predatorPosition).GetIndex();
+            AE_COUNT(COUNTER_HUNT_PROBES);
             if (IsOccupied(randomIndex) and predator != nullptr) {
 
                 emp::Ptr<Organism> neighbor = pop[randomIndex];
-                if (neighbor->GetType() == "Prey") {
+                if (neighbor->GetSpecies() == Species::Prey) {
+                    stats.hunts++;
                     predator = GetPredator(predatorPosition);
-                    int indexToDie = predator->Hunt(neighbor, predatorPosition, randomIndex);
+                    int indexToDie = predator->Hunt(neighbor, predatorPosition, randomIndex, params);
+                    if (replayLog) {
+                        bool predatorWins = indexToDie == randomIndex;
+                        replayLog->Record(ReplayEventType::Hunt, Species::Predator, predatorPosition, randomIndex,
+                                          predatorWins ? predator->GetStrength() : neighbor->GetStrength(),
+                                          Species::Prey, predatorWins);
+                    }
                     DoDeath(indexToDie);
 
                     // if predator is still alive, it successfully killed its prey
                     predator = GetPredator(predatorPosition);
-                    if (predator != nullptr) { numKills++; }
-                    else { break; }
+                    if (predator != nullptr) {
+                        numKills++;
+                        AE_COUNT(COUNTER_HUNT_KILLS);
+                    }
+                    else {
+                        AE_COUNT(COUNTER_HUNT_DEFEATS);
+                        break;
+                    }
                 }
             }
         }
@@ -119,7 +491,12 @@ class OrgWorld : public emp::World<Organism> {
         // if predator is still alive but hasn't eaten any prey, reduce its strength due to lack of food
         predator = GetPredator(predatorPosition);
         if (predator != nullptr and numKills == 0){
-            predator->AddStrength(-.01 * predator->GetStrength());
+            AE_COUNT(COUNTER_HUNT_MISSES);
+            predator->AddStrength(-params.starvationLoss * predator->GetStrength());
+            if (replayLog) {
+                replayLog->Record(ReplayEventType::Starve, Species::Predator, predatorPosition, predatorPosition,
+                                  predator->GetStrength());
+            }
         }
     }
     
@@ -131,7 +508,12 @@ class OrgWorld : public emp::World<Organism> {
     void ManageDeathAtIdx(int currentIndex) {
         emp::Ptr<Organism> currentOrganism = pop[currentIndex];
         if (currentOrganism != nullptr) {
-            if (currentOrganism->GetStrength() < 50.0) {
+            if (currentOrganism->GetStrength() < params.deathThreshold) {
+                AE_COUNT(COUNTER_WEAKNESS_DEATHS);
+                if (replayLog) {
+                    replayLog->Record(ReplayEventType::Death, currentOrganism->GetSpecies(), currentIndex, currentIndex,
+                                      currentOrganism->GetStrength());
+                }
                 DoDeath(currentIndex);
             }
         }
@@ -145,9 +527,23 @@ class OrgWorld : public emp::World<Organism> {
     void ManageReproductionAtIdx(int currentIndex) {
         emp::Ptr<Organism> currentOrganism = pop[currentIndex];
         if (currentOrganism != nullptr) {
-            emp::Ptr<Organism> offspring = currentOrganism->CheckReproduction(); 
+            emp::Ptr<Organism> offspring = virtualDispatch ? currentOrganism->CheckReproduction(pool, params)
+                                                           : Reproduce(*currentOrganism, pool, random, params);
             if(offspring) { // give birth to offspring and add it to world
-                AddOrgAt(offspring, GetRandomNeighborPos(currentIndex));
+                stats.births++;
+                emp::WorldPosition birthPosition = GetRandomNeighborPos(currentIndex);
+                AE_COUNT(COUNTER_BIRTHS);
+                if (IsOccupied(birthPosition)) {AE_COUNT(COUNTER_BIRTHS_OVERWRITING);}
+                if ((int) birthPosition.GetIndex() == currentIndex) {AE_COUNT(COUNTER_BIRTHS_OVER_PARENT);}
+                if (replayLog) {
+                    replayLog->Record(ReplayEventType::Birth, offspring->GetSpecies(), currentIndex,
+                                      birthPosition.GetIndex(), offspring->GetStrength());
+                }
+                if (lineage) { // the offspring was copied from its parent, so it still holds the parent's node
+                    offspring->SetLineage(lineage->AddBirth(offspring->GetLineage(), offspring->GetSpecies(),
+                                                            offspring->GetStrength(), GetUpdate()));
+                }
+                AddOrgAt(offspring, birthPosition);
             }
         }
     }
@@ -157,37 +553,79 @@ class OrgWorld : public emp::World<Organism> {
      * Updates reproduction points and strength levels for each organism and faciliates movement, hunting, death, and reproduction.
      */
     void Update() {
+        AE_TRACE_SCOPE("update");
         emp::World<Organism>::Update();
-        // permutation ensures that organisms early in the population don't have an advantage
-        emp::vector<size_t> schedule = emp::GetPermutation(random, GetSize()); 
-        for (int i : schedule) {
-            if(!IsOccupied(i)) {
-                continue;
+        ResetUpdateStats();
+        if (replayLog) {replayLog->Record(ReplayEventType::Update, Species::Org, GetUpdate(), 0, 0.0);}
+        {
+            AE_TRACE_SCOPE("accrual");
+            PhaseTimer timer(profile, PHASE_ACCRUAL);
+            if (scheduler.IsTracking()) { // order doesn't matter here, so the occupied cells needn't be shuffled
+                for (size_t i : scheduler.GetOccupied()) {
+                    pop[i]->AddPoints(params.pointsPerUpdate); // as time passes, organism's ability to reproduce increases
+                    if (statsWriter) {SampleStrength(pop[i]);}
+                }
             }
             else {
-                pop[i]->AddPoints(100.0); // as time passes, organism's ability to reproduce increases
+                // permutation ensures that organisms early in the population don't have an advantage
+                for (size_t i : scheduler.Permutation(random, GetSize())) {
+                    if(!IsOccupied(i)) {
+                        continue;
+                    }
+                    else {
+                        pop[i]->AddPoints(params.pointsPerUpdate); // as time passes, organism's ability to reproduce increases
+                        if (statsWriter) {SampleStrength(pop[i]);}
+                    }
+                }
             }
         }
 
-        // permutation ensures that organisms early in the population don't have an advantage
-        schedule = emp::GetPermutation(random, GetSize());
-        for (int i : schedule) {
-            if(!IsOccupied(i)) {
-                continue;
-            }
-            else {
-                // moves organism and executes changes (hunting, death, and reproduction) at its new position
-                emp::Ptr<Organism> currentOrganism = pop[i];
-                int newIndex = MoveOrganism(i);
-                if (newIndex != -INFINITY) {
-                    if (currentOrganism->GetType() == "Predator"){
-                        ManageHuntingAtIdx(newIndex); // executes hunt in and around newIndex
+        {
+            AE_TRACE_SCOPE("turns");
+            // permutation ensures that organisms early in the population don't have an advantage
+            const emp::vector<size_t> &schedule = scheduler.IsTracking() ? scheduler.Shuffle(random, scheduler.GetOccupied())
+                                                                         : scheduler.Permutation(random, GetSize());
+            for (int i : schedule) {
+                if(!IsOccupied(i)) {
+                    continue;
+                }
+                else {
+                    if (profile) {profile->organismsProcessed++;}
+
+                    // moves organism and executes changes (hunting, death, and reproduction) at its new position
+                    emp::Ptr<Organism> currentOrganism = pop[i];
+                    int newIndex;
+                    {
+                        PhaseTimer timer(profile, PHASE_MOVE);
+                        newIndex = MoveOrganism(i);
+                    }
+                    if (newIndex >= 0) {
+                        if (currentOrganism->GetSpecies() == Species::Predator){
+                            PhaseTimer timer(profile, PHASE_HUNT);
+                            ManageHuntingAtIdx(newIndex); // executes hunt in and around newIndex
+                        }
+                        {
+                            PhaseTimer timer(profile, PHASE_DEATH);
+                            ManageDeathAtIdx(newIndex); // determines if org at newIndex should die
+                        }
+                        {
+                            PhaseTimer timer(profile, PHASE_REPRODUCTION);
+                            ManageReproductionAtIdx(newIndex); // determines if org at newIndex should reproduce
+                        }
                     }
-                    ManageDeathAtIdx(newIndex); // determines if org at newIndex should die
-                    ManageReproductionAtIdx(newIndex); // determines if org at newIndex should reproduce
                 }
             }
-        } 
+        }
+
+        if (clusters) {
+            AE_TRACE_SCOPE("clusters");
+            clusters->EndUpdate(GetUpdate());
+        }
+        AE_TRACE_COUNTERS();
+        if (statsWriter) {
+            stats.update = GetUpdate();
+            statsWriter->Record(stats);
+        }
     }
 
 };
@@ -0,0 +1,5 @@
+g++ -std=c++17 -O3 -DNDEBUG -pthread -IEmpirical/include/ AEHeadless.cpp -o AEHeadless
+g++ -std=c++17 -O3 -DNDEBUG -pthread -IEmpirical/include/ AEBenchmark.cpp -o AEBenchmark
+g++ -std=c++17 -O3 -DNDEBUG -pthread -IEmpirical/include/ AESweep.cpp -o AESweep
+g++ -std=c++17 -O3 -DNDEBUG -pthread -IEmpirical/include/ AEReplay.cpp -o AEReplay
+g++ -std=c++17 -O3 -DNDEBUG -pthread -IEmpirical/include/ AEMutationTest.cpp -o AEMutationTest
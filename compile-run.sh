@@ -1,2 +1,2 @@
-emcc -std=c++17 -IEmpirical/include/ -Os --js-library Empirical/include/emp/web/library_emp.js -s EXPORTED_FUNCTIONS="['_main', '_empCppCallback', '_empDoCppCallback']" -s "EXTRA_EXPORTED_RUNTIME_METHODS=['ccall', 'cwrap']" -s ALLOW_MEMORY_GROWTH=1 -s NO_EXIT_RUNTIME=1 AEAnimate.cpp -o AEAnimate.js
-python3 -m http.server
\ No newline at end of file
+emcc -std=c++17 -IEmpirical/include/ -Os -pthread -s USE_PTHREADS=1 -s PTHREAD_POOL_SIZE=1 --js-library Empirical/include/emp/web/library_emp.js -s EXPORTED_FUNCTIONS="['_main', '_empCppCallback', '_empDoCppCallback']" -s "EXTRA_EXPORTED_RUNTIME_METHODS=['ccall', 'cwrap']" -lidbfs.js -s FORCE_FILESYSTEM=1 -s ALLOW_MEMORY_GROWTH=1 -s NO_EXIT_RUNTIME=1 AEAnimate.cpp -o AEAnimate.js
+python3 serve.py
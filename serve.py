@@ -0,0 +1,13 @@
+# Serves the web build at http://localhost:8000/ with the cross-origin isolation headers browsers require before
+# they allow SharedArrayBuffer, which the threaded build's shared memory is made of.
+import http.server
+
+
+class IsolatedHandler(http.server.SimpleHTTPRequestHandler):
+    def end_headers(self):
+        self.send_header("Cross-Origin-Opener-Policy", "same-origin")
+        self.send_header("Cross-Origin-Embedder-Policy", "require-corp")
+        super().end_headers()
+
+
+http.server.ThreadingHTTPServer(("", 8000), IsolatedHandler).serve_forever()